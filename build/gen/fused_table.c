@@ -0,0 +1,27 @@
+// Generated by tools/gen_fused_table.sh - do not edit
+#include "field_common.h"
+
+FIELD_FUSED_DECLARE(field_1)
+FIELD_FUSED_DECLARE(field_2)
+FIELD_FUSED_DECLARE(field_3)
+FIELD_FUSED_DECLARE(field_4)
+FIELD_FUSED_DECLARE(field_5)
+FIELD_FUSED_DECLARE(field_6)
+FIELD_FUSED_DECLARE(field_7)
+FIELD_FUSED_DECLARE(field_8)
+FIELD_FUSED_DECLARE(field_9)
+
+const IntegratorFusedFunc integrator_fused_table[][INTEGRATOR_COUNT][MATH_PRECISION_COUNT][SIMD_ISA_COUNT] = {
+    FIELD_FUSED_ENTRIES(0, field_1)
+    FIELD_FUSED_ENTRIES(1, field_2)
+    FIELD_FUSED_ENTRIES(2, field_3)
+    FIELD_FUSED_ENTRIES(3, field_4)
+    FIELD_FUSED_ENTRIES(4, field_5)
+    FIELD_FUSED_ENTRIES(5, field_6)
+    FIELD_FUSED_ENTRIES(6, field_7)
+    FIELD_FUSED_ENTRIES(7, field_8)
+    FIELD_FUSED_ENTRIES(8, field_9)
+};
+
+const int integrator_fused_table_size =
+    (int)(sizeof(integrator_fused_table) / sizeof(integrator_fused_table[0]));
@@ -1,7 +1,8 @@
 #version 330 core
-uniform vec4 u_fade_color;
+uniform sampler2D u_previous;  // Last frame's accumulation, same size as the target
+uniform float u_retain;        // Fraction left after this frame's fade
 out vec4 FragColor;
 
 void main() {
-    FragColor = u_fade_color;
-}
\ No newline at end of file
+    FragColor = texelFetch(u_previous, ivec2(gl_FragCoord.xy), 0) * u_retain;
+}
@@ -0,0 +1,161 @@
+// GLSL ports of the scalar fields in src/fields (FIELD_IMPL), appended to
+// the particle shaders (shaders/particles_common.glsl declares
+// field_velocity). FIELD (Config.vector_field_num) selects the field at
+// compile time. Keep in sync with the C code.
+
+const float PI = 3.14159265;
+const float TWO_PI = 6.28318531;
+
+// Field 1: Lorenz field
+vec2 field_1(vec2 p, float scale) {
+    float sigma = 10.0;
+    float rho = 28.0;
+    return vec2(sigma * (p.y - p.x) * 0.05 * scale,
+                (p.x * (rho - p.x * p.x - p.y * p.y) - p.y) * 0.05 * scale);
+}
+
+// Field 2: Wavy Hyperbolic Flow
+vec2 field_2(vec2 p, float scale) {
+    return vec2(sin(5.0 * p.y + p.x), cos(5.0 * p.x - p.y)) * scale;
+}
+
+// Field 3: Crystalline Nebula
+vec2 field_3(vec2 p, float scale) {
+    float r = sqrt(p.x * p.x + p.y * p.y);
+    float theta = atan(p.y, p.x);
+
+    float r_inv = 1.0 / (r + 0.5);
+    float r_scaled = r * 4.0;
+
+    // 1. Hexagonal (angle1 = 0 projects onto x)
+    float proj2 = p.x * cos(PI / 3.0) + p.y * sin(PI / 3.0);
+    float hex = (cos(p.x * 4.0) + cos(proj2 * 4.0)) * 0.1;
+
+    // 2. Interference
+    float interference = (sin(r * 2.5 + theta) + sin(r * 5.0 + theta * 2.0) * 0.5) * 0.1;
+
+    // 3. Organic flow
+    float flow_x = sin(p.y * 2.0 + cos(p.x * 1.5)) * 0.6;
+    float flow_y = cos(p.x * 2.0 + sin(p.y * 1.5)) * 0.6;
+
+    // 4. Radial breathing
+    float breath = sin(r * 3.0) * exp(-r * 0.3) * 0.4;
+
+    // 5. Tangential swirl
+    float swirl_strength = (1.0 + sin(r_scaled - theta * 8.0)) * 0.5;
+    float swirl_x = -p.y * swirl_strength * r_inv;
+    float swirl_y = p.x * swirl_strength * r_inv;
+
+    // 6. Fractal
+    float px = abs(p.x) - 0.5;
+    float py = abs(p.y) - 0.5;
+    float fractal = sin(px * 2.0 + py) * 0.1;
+
+    float cos_theta = cos(theta * 5.0);
+    float sin_theta = sin(theta * 5.0);
+
+    vec2 v;
+    v.x = swirl_x
+          + flow_x * (1.0 + hex)
+          + cos_theta * breath
+          + interference * sin_theta
+          + fractal * cos(r * 2.0);
+    v.y = swirl_y
+          + flow_y * (1.0 + hex)
+          + sin_theta * breath
+          + interference * cos_theta
+          + fractal * sin(r * 2.0);
+    return v * scale;
+}
+
+// Field 4: Hopf field
+vec2 field_4(vec2 p, float scale) {
+    float mu = 1.0 - (p.x * p.x + p.y * p.y);
+    return vec2(mu * p.x - p.y, p.x + mu * p.y) * scale;
+}
+
+// Field 5: Radial Wave Vortex
+vec2 field_5(vec2 p, float scale) {
+    float r = length(p);
+    return vec2(-p.y + sin(r * 2.0) * 0.3, p.x + cos(r * 2.0) * 0.3) * scale;
+}
+
+// Field 6: Karman Vortex Street
+vec2 field_6(vec2 p, float scale) {
+    const float frequency = 2.0;
+    const float strength = 1.0;
+
+    float vortex1_y = sin(p.x * frequency) * 0.5;
+    float vortex2_y = sin(p.x * frequency + PI) * 0.5;
+
+    float dist1 = distance(p, vec2(0.0, vortex1_y)) + 0.1;
+    float dist2 = distance(p, vec2(0.0, vortex2_y)) + 0.1;
+
+    vec2 v1 = vec2(-(p.y - vortex1_y), p.x) / dist1;
+    vec2 v2 = vec2(p.y - vortex2_y, -p.x) / dist2;
+
+    return strength * (v1 + v2 + vec2(0.5, 0.0)) * scale;
+}
+
+// Field 7: Double Gyre
+vec2 field_7(vec2 p, float scale) {
+    const float A = 0.1;
+    const float epsilon = 0.25;
+    const float omega = TWO_PI / 10.0;
+
+    float time_param = p.x + p.y * 0.5;
+    float a = epsilon * sin(omega * time_param);
+    float b = 1.0 - 2.0 * epsilon * sin(omega * time_param);
+    float f = a * p.x * p.x + b * p.x;
+
+    vec2 v;
+    v.x = -PI * A * sin(PI * f) * cos(PI * p.y);
+    v.y = PI * A * cos(PI * f) * sin(PI * p.y) * (2.0 * a * p.x + b);
+
+    v.x += sin(p.y * 3.0) * 0.1;
+    v.y += cos(p.x * 3.0) * 0.1;
+    return v * scale;
+}
+
+// Field 8: Galaxy Spiral
+vec2 field_8(vec2 p, float scale) {
+    float r = length(p);
+    float theta = atan(p.y, p.x);
+
+    float vr = -0.2 * r;
+    float vtheta = 0.5 / (r + 0.1);
+
+    return vec2(vr * cos(theta) - vtheta * sin(theta),
+                vr * sin(theta) + vtheta * cos(theta)) * scale;
+}
+
+// Field 9: Van der Pol Oscillator
+vec2 field_9(vec2 p, float scale) {
+    const float mu = 2.0;
+    return vec2(p.y, mu * (1.0 - p.x * p.x) * p.y - p.x) * scale;
+}
+
+// Velocity of field FIELD; unknown fields stand still
+vec2 field_velocity(vec2 p, float scale) {
+#if FIELD == 0
+    return field_1(p, scale);
+#elif FIELD == 1
+    return field_2(p, scale);
+#elif FIELD == 2
+    return field_3(p, scale);
+#elif FIELD == 3
+    return field_4(p, scale);
+#elif FIELD == 4
+    return field_5(p, scale);
+#elif FIELD == 5
+    return field_6(p, scale);
+#elif FIELD == 6
+    return field_7(p, scale);
+#elif FIELD == 7
+    return field_8(p, scale);
+#elif FIELD == 8
+    return field_9(p, scale);
+#else
+    return vec2(0.0);
+#endif
+}
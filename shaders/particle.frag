@@ -1,7 +1,8 @@
 #version 330 core
+uniform float u_weight;  // Share of a reference frame this frame deposits
 in vec4 v_color;
 out vec4 FragColor;
 
 void main() {
-    FragColor = v_color;
-}
\ No newline at end of file
+    FragColor = vec4(v_color.rgb, v_color.a * u_weight);
+}
@@ -1,12 +1,17 @@
 #version 330 core
-layout(location = 0) in vec2 a_position;
-layout(location = 1) in vec4 a_color;
+layout(location = 0) in vec4 a_vertex;  // Position / 2, speed, alpha
 
-uniform mat4 u_projection;
+uniform sampler1D u_colormap;
 
 out vec4 v_color;
+flat out float v_head_alpha;
 
 void main() {
-    gl_Position = u_projection * vec4(a_position, 0.0, 1.0);
-    v_color = a_color;
+    gl_Position = vec4(a_vertex.xy * 2.0, 0.0, 1.0);
+    
+    // Sample between the first and last texel centers
+    float n = float(textureSize(u_colormap, 0));
+    float s = (0.5 + a_vertex.z * (n - 1.0)) / n;
+    v_color = vec4(texture(u_colormap, s).rgb, a_vertex.w);
+    v_head_alpha = a_vertex.w;
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 330 core
+uniform float u_weight;    // Share of a reference frame this frame deposits
+in vec4 v_color;
+flat in float v_head_alpha;  // From the provoking (last, head) vertex
+
+out vec4 FragColor;
+
+void main() {
+    // Fragments of a line reach up to a pixel past its ends, and the alpha
+    // is extrapolated there: clamp it to the segment's own range (the tail
+    // has half the head's alpha), or sub-pixel segments deposit garbage
+    float alpha = clamp(v_color.a, 0.5 * v_head_alpha, v_head_alpha);
+    FragColor = vec4(v_color.rgb, alpha * u_weight);
+}
@@ -0,0 +1,30 @@
+#version 330 core
+layout(location = 0) in vec4 a_segment;  // Tail, head: position / 2 (per instance)
+layout(location = 1) in float a_speed;   // Per instance
+
+uniform sampler1D u_colormap;
+uniform vec2 u_pixel;   // Clip space size of one pixel
+uniform float u_width;  // Segment width in pixels
+uniform float u_alpha;  // Head alpha; the tail gets half
+
+out vec4 v_color;
+
+void main() {
+    // Triangle strip corners: tail left, tail right, head left, head right
+    float along = float(gl_VertexID >> 1);
+    float side = float(gl_VertexID & 1) * 2.0 - 1.0;
+    
+    vec2 tail = a_segment.xy * 2.0;
+    vec2 head = a_segment.zw * 2.0;
+    
+    // Offset perpendicular to the segment, measured in pixels
+    vec2 d = (head - tail) / u_pixel;
+    float len = length(d);
+    vec2 normal = len > 0.0 ? vec2(-d.y, d.x) / len : vec2(0.0, 1.0);
+    vec2 position = mix(tail, head, along) + normal * (side * 0.5 * u_width) * u_pixel;
+    gl_Position = vec4(position, 0.0, 1.0);
+    
+    float n = float(textureSize(u_colormap, 0));
+    float s = (0.5 + a_speed * (n - 1.0)) / n;
+    v_color = vec4(texture(u_colormap, s).rgb, u_alpha * (0.5 + 0.5 * along));
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+// Particle simulation shared by the compute (shaders/particles.comp) and
+// transform feedback (shaders/particles_feedback.vert) paths of
+// src/gpu_particles.c. The program is a prelude with the #version line and
+// the PASS, FIELD, INTEGRATOR and MODE defines, this file, the pass file
+// and shaders/fields.glsl, so each pass compiles only its own code.
+
+#define PASS_STEP 0    // Integrate one step, respawn expired and escaped particles
+#define PASS_EMIT 1    // Write the frame's vertex records
+#define PASS_SPAWN 2   // Redistribute over the view (jittered grid or uniform)
+
+// Integrators (IntegratorType; RK45 runs as RK4)
+#define INTEGRATOR_EULER 0
+#define INTEGRATOR_MIDPOINT 1
+
+// Record layouts (RenderMode)
+#define RENDER_QUADS 1
+
+// Streams of src/rng.h
+#define RNG_STREAM_RESPAWN 1u
+#define RNG_STREAM_REDISTRIBUTE 2u
+#define RNG_STREAM_GRID 3u
+
+uniform int u_count;
+uniform uint u_seed;
+uniform uint u_frame;       // RNG counter word, as ParticleSystem.frame
+uniform vec4 u_view;        // left, right, bottom, top
+uniform vec2 u_margin;      // Respawn margin around the view
+
+// PASS_STEP
+uniform float u_scale;
+uniform float u_dt;
+uniform float u_lifetime;   // Config.particle_lifetime
+
+// PASS_EMIT
+uniform float u_interpolate;  // Render time between the previous (0) and current (1) step
+uniform float u_alpha;        // Head vertex alpha; the tail gets half
+
+// PASS_SPAWN
+uniform int u_grid_size;      // Jittered grid cells per side (0 = uniform)
+uniform float u_lifetime_mult;
+
+vec2 field_velocity(vec2 p, float scale);
+
+// umulExtended, spelled out where GLSL 3.30 lacks it
+void mul_extended(uint a, uint b, out uint hi, out uint lo) {
+#if __VERSION__ >= 400
+    umulExtended(a, b, hi, lo);
+#else
+    uint a0 = a & 0xFFFFu, a1 = a >> 16u;
+    uint b0 = b & 0xFFFFu, b1 = b >> 16u;
+    uint p01 = a0 * b1, p10 = a1 * b0;
+    uint mid = ((a0 * b0) >> 16u) + (p01 & 0xFFFFu) + (p10 & 0xFFFFu);
+    hi = a1 * b1 + (p01 >> 16u) + (p10 >> 16u) + (mid >> 16u);
+    lo = a * b;
+#endif
+}
+
+// packSnorm2x16, likewise
+uint pack_snorm2x16(vec2 v) {
+#if __VERSION__ >= 420
+    return packSnorm2x16(v);
+#else
+    ivec2 bits = ivec2(round(clamp(v, -1.0, 1.0) * 32767.0));
+    return uint(bits.x & 0xFFFF) | (uint(bits.y & 0xFFFF) << 16u);
+#endif
+}
+
+// Philox4x32-10, bit-identical to rng_philox4x32 with a 32-bit seed
+uvec4 philox4x32(uvec4 c, uvec2 k) {
+    for (int round = 0; round < 10; round++) {
+        uint hi0, lo0, hi1, lo1;
+        mul_extended(0xD2511F53u, c.x, hi0, lo0);
+        mul_extended(0xCD9E8D57u, c.z, hi1, lo1);
+        c = uvec4(hi1 ^ c.y ^ k.x, lo1, hi0 ^ c.w ^ k.y, lo0);
+        k += uvec2(0x9E3779B9u, 0xBB67AE85u);
+    }
+    return c;
+}
+
+// rng_uniform4: four uniforms in [0, 1) for particle `index`
+vec4 rng_uniform4(uint index, uint stream) {
+    uvec4 bits = philox4x32(uvec4(index, u_frame, stream, 0u), uvec2(u_seed, 0u));
+    return vec4(bits >> 8u) * (1.0 / 16777216.0);
+}
+
+// Color speed (particle_speed)
+float particle_speed(vec2 v) {
+    return min(dot(v, v) * 0.25, 1.0);
+}
+
+// One step of particle i. position is (x, y, prev_x, prev_y) in world
+// space, state is (lifetime, normalized speed).
+void step_particle(uint i, inout vec4 position, inout vec2 state) {
+    vec2 p = position.xy;
+    vec2 k1 = field_velocity(p, u_scale);
+    float speed = particle_speed(k1);
+    float dt = u_dt;
+
+#if INTEGRATOR == INTEGRATOR_EULER
+    p += k1 * dt;
+#elif INTEGRATOR == INTEGRATOR_MIDPOINT
+    p += field_velocity(p + k1 * (dt * 0.5), u_scale) * dt;
+#else
+    vec2 k2 = field_velocity(p + k1 * (dt * 0.5), u_scale);
+    vec2 k3 = field_velocity(p + k2 * (dt * 0.5), u_scale);
+    vec2 k4 = field_velocity(p + k3 * dt, u_scale);
+    p += (k1 + 2.0 * k2 + 2.0 * k3 + k4) * (dt * 0.16666667);
+#endif
+
+    position = vec4(p, position.xy);
+    float lifetime = state.x + dt;
+
+    bool outside = p.x < u_view.x - u_margin.x || p.x > u_view.y + u_margin.x ||
+                   p.y < u_view.z - u_margin.y || p.y > u_view.w + u_margin.y;
+    if (outside || lifetime > u_lifetime) {
+        // Uniform over the view (the CPU path before its first occupancy histogram)
+        vec4 u = rng_uniform4(i, RNG_STREAM_RESPAWN);
+        vec2 spawn = vec2(mix(u_view.x, u_view.y, u.y), mix(u_view.z, u_view.w, u.z));
+        position = vec4(spawn, spawn);
+        lifetime = u.w * u_lifetime * 0.2;
+    }
+
+    state = vec2(lifetime, speed);
+}
+
+// Same placement as particle_system_redistribute(_grid)
+void spawn_particle(uint i, out vec4 position, out vec2 state) {
+    vec2 extent = vec2(u_view.y - u_view.x, u_view.w - u_view.z);
+    vec2 p;
+    vec4 u;
+    int grid_cells = u_grid_size * u_grid_size;
+
+    if (int(i) < grid_cells) {
+        u = rng_uniform4(i, RNG_STREAM_GRID);
+        vec2 step = extent / float(u_grid_size);
+        vec2 cell = vec2(int(i) / u_grid_size, int(i) % u_grid_size);
+        vec2 jitter = (u.xy - 0.5) * step * 0.8;
+        p = u_view.xz + (cell + 0.5) * step + jitter;
+    } else {
+        u = rng_uniform4(i, u_grid_size > 0 ? RNG_STREAM_GRID : RNG_STREAM_REDISTRIBUTE);
+        p = vec2(mix(u_view.x, u_view.y, u.x), mix(u_view.z, u_view.w, u.y));
+    }
+
+    position = vec4(p, p);
+    state = vec2(u.z * u_lifetime_mult, 0.0);
+}
+
+// Segment ends in normalized view coordinates at render time u_interpolate
+void segment_ends(vec4 position, out vec2 tail, out vec2 head) {
+    vec2 center = vec2(u_view.x + u_view.y, u_view.z + u_view.w) * 0.5;
+    vec2 extent = vec2(u_view.y - u_view.x, u_view.w - u_view.z);
+    vec2 base = (position.zw - center) / extent;
+    vec2 delta = (position.xy - position.zw) / extent;
+    tail = base + delta * (u_interpolate - 1.0);
+    head = base + delta * u_interpolate;
+}
+
+// Same records as emit_vertices / emit_instances in src/renderer.c: a
+// ParticleVertex pair for lines, a ParticleInstance for quads
+#if MODE == RENDER_QUADS
+uvec3 particle_record(vec4 position, float speed) {
+    vec2 tail, head;
+    segment_ends(position, tail, head);
+    return uvec3(pack_snorm2x16(tail), pack_snorm2x16(head), pack_snorm2x16(vec2(speed, 0.0)));
+}
+#else
+uvec4 particle_record(vec4 position, float speed) {
+    vec2 tail, head;
+    segment_ends(position, tail, head);
+    return uvec4(pack_snorm2x16(tail), pack_snorm2x16(vec2(speed, u_alpha * 0.5)),
+                 pack_snorm2x16(head), pack_snorm2x16(vec2(speed, u_alpha)));
+}
+#endif
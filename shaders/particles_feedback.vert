@@ -0,0 +1,35 @@
+// Transform feedback passes of the GPU particle simulation (GL 3.3), one
+// vertex per particle drawn as points with rasterization off. Steps read
+// one pair of state buffers and write the other. See
+// shaders/particles_common.glsl for how the program is assembled.
+
+#if PASS == PASS_EMIT
+layout(location = 0) in vec4 a_position;
+layout(location = 1) in vec2 a_state;
+#if MODE == RENDER_QUADS
+flat out uvec3 tf_record;
+#else
+flat out uvec4 tf_record;
+#endif
+#else
+#if PASS == PASS_STEP
+layout(location = 0) in vec4 a_position;
+layout(location = 1) in vec2 a_state;
+#endif
+out vec4 tf_position;
+out vec2 tf_state;
+#endif
+
+void main() {
+    uint i = uint(gl_VertexID);
+
+#if PASS == PASS_STEP
+    tf_position = a_position;
+    tf_state = a_state;
+    step_particle(i, tf_position, tf_state);
+#elif PASS == PASS_EMIT
+    tf_record = particle_record(a_position, a_state.y);
+#else
+    spawn_particle(i, tf_position, tf_state);
+#endif
+}
@@ -0,0 +1,15 @@
+#version 330 core
+uniform sampler2D u_accumulation;
+in vec2 v_uv;
+out vec4 FragColor;
+
+// Tone map: linear up to the knee, so the usual brightness range looks as it
+// did in an 8-bit framebuffer, then an exponential shoulder that approaches
+// white instead of clipping
+const float KNEE = 0.8;
+
+void main() {
+    vec3 c = texture(u_accumulation, v_uv).rgb;
+    vec3 over = max(c - KNEE, 0.0);
+    FragColor = vec4(min(c, KNEE) + (1.0 - KNEE) * (1.0 - exp(-over / (1.0 - KNEE))), 1.0);
+}
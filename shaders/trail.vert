@@ -0,0 +1,24 @@
+#version 330 core
+uniform samplerBuffer u_history;  // World positions, one row per step, one column per particle
+uniform usamplerBuffer u_state;   // Per column: valid positions, speed * 255
+uniform sampler1D u_colormap;
+uniform vec4 u_view;   // View center, clip units per world unit
+uniform ivec3 u_rows;  // Newest row, rows, columns
+uniform float u_alpha; // Alpha of the newest position
+
+out vec4 v_color;
+
+void main() {
+    // One line strip per instance (column), newest position first. Past the
+    // valid positions the oldest one repeats, and zero-length segments draw
+    // nothing.
+    uvec2 state = texelFetch(u_state, gl_InstanceID).xy;
+    int age = min(gl_VertexID, max(int(state.x) - 1, 0));
+    int row = (u_rows.x - age + u_rows.y) % u_rows.y;
+    vec2 position = texelFetch(u_history, row * u_rows.z + gl_InstanceID).xy;
+    gl_Position = vec4((position - u_view.xy) * u_view.zw, 0.0, 1.0);
+    
+    float n = float(textureSize(u_colormap, 0));
+    float s = (0.5 + float(state.y) / 255.0 * (n - 1.0)) / n;
+    v_color = vec4(texture(u_colormap, s).rgb, u_alpha * (1.0 - float(age) / float(u_rows.y)));
+}
\ No newline at end of file
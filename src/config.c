@@ -3,6 +3,60 @@
 #include <stdlib.h>
 #include <string.h>
 
+static const char* math_precision_names[MATH_PRECISION_COUNT] = {
+    "visual", "reference"
+};
+
+const char* config_math_precision_name(MathPrecision precision) {
+    if (precision < 0 || precision >= MATH_PRECISION_COUNT) return "visual";
+    return math_precision_names[precision];
+}
+
+static const char* integrator_names[INTEGRATOR_COUNT] = {
+    "euler", "midpoint", "rk4", "rk45"
+};
+
+const char* config_integrator_name(IntegratorType integrator) {
+    if (integrator < 0 || integrator >= INTEGRATOR_COUNT) return "rk4";
+    return integrator_names[integrator];
+}
+
+static const char* field_cache_names[FIELD_CACHE_COUNT] = {
+    "off", "bilinear", "bicubic"
+};
+
+const char* config_field_cache_name(FieldCacheMode mode) {
+    if (mode < 0 || mode >= FIELD_CACHE_COUNT) return "off";
+    return field_cache_names[mode];
+}
+
+static const char* render_mode_names[RENDER_MODE_COUNT] = {
+    "lines", "quads"
+};
+
+const char* config_render_mode_name(RenderMode mode) {
+    if (mode < 0 || mode >= RENDER_MODE_COUNT) return "lines";
+    return render_mode_names[mode];
+}
+
+static const char* render_backend_names[RENDER_BACKEND_COUNT] = {
+    "opengl", "software"
+};
+
+const char* config_render_backend_name(RenderBackend backend) {
+    if (backend < 0 || backend >= RENDER_BACKEND_COUNT) return "opengl";
+    return render_backend_names[backend];
+}
+
+static const char* simulation_backend_names[SIMULATION_BACKEND_COUNT] = {
+    "cpu", "gpu", "feedback"
+};
+
+const char* config_simulation_backend_name(SimulationBackend backend) {
+    if (backend < 0 || backend >= SIMULATION_BACKEND_COUNT) return "cpu";
+    return simulation_backend_names[backend];
+}
+
 // Create default configuration
 Config config_create_default() {
     Config config;
@@ -25,15 +79,34 @@ Config config_create_default() {
     // Vector field settings
     config.vector_field_num = 1;
     config.field_scale = 1.0f;
+    config.math_precision = MATH_PRECISION_VISUAL;
+    config.field_cache = FIELD_CACHE_OFF;
+    config.flow_map = false;
     
     // Integration settings
+    config.integrator = INTEGRATOR_RK4;
     config.integration_step = 0.01f;
+    config.integration_tolerance = 0.05f;
+    config.integration_max_steps = 8;
+    config.multirate_interval = 8;
+    config.multirate_pixels = 2.0f;
     
     // Simulation settings
+    config.simulation_backend = SIMULATION_CPU;
     config.simulation_speed = 1.0f;
+    config.simulation_rate = 60.0f;
+    config.max_substeps = 4;
+    config.sort_interval = 120;
+    config.sort_disorder = 0.25f;
     config.paused = false;
+    config.threads = 0;  // 0 = auto
+    config.random_seed = 0;  // 0 = from the clock
     
     // Rendering settings
+    config.render_backend = RENDER_BACKEND_OPENGL;
+    config.render_mode = RENDER_LINES;
+    config.fused_emit = true;
+    config.render_scale = 1.0f;
     config.background_color[0] = 0.1f;  // R
     config.background_color[1] = 0.1f;  // G
     config.background_color[2] = 0.1f;  // B
@@ -100,10 +173,105 @@ bool config_load_from_file(Config* config, const char* filename) {
                 config->vector_field_num = (int)atoi(value_start);
             } else if (strcmp(key_start, "field_scale") == 0) {
                 config->field_scale = (float)atof(value_start);
+            } else if (strcmp(key_start, "math_precision") == 0) {
+                int found = -1;
+                for (int i = 0; i < MATH_PRECISION_COUNT; i++) {
+                    if (strcmp(value_start, math_precision_names[i]) == 0) found = i;
+                }
+                if (found < 0) {
+                    printf("Warning: Unknown math_precision '%s', using visual\n", value_start);
+                    found = MATH_PRECISION_VISUAL;
+                }
+                config->math_precision = (MathPrecision)found;
+            } else if (strcmp(key_start, "field_cache") == 0) {
+                int found = -1;
+                for (int i = 0; i < FIELD_CACHE_COUNT; i++) {
+                    if (strcmp(value_start, field_cache_names[i]) == 0) found = i;
+                }
+                if (found < 0) {
+                    printf("Warning: Unknown field_cache '%s', using off\n", value_start);
+                    found = FIELD_CACHE_OFF;
+                }
+                config->field_cache = (FieldCacheMode)found;
+            } else if (strcmp(key_start, "flow_map") == 0) {
+                config->flow_map = strcmp(value_start, "on") == 0;
+            } else if (strcmp(key_start, "integrator") == 0) {
+                int found = -1;
+                for (int i = 0; i < INTEGRATOR_COUNT; i++) {
+                    if (strcmp(value_start, integrator_names[i]) == 0) found = i;
+                }
+                if (found < 0) {
+                    printf("Warning: Unknown integrator '%s', using rk4\n", value_start);
+                    found = INTEGRATOR_RK4;
+                }
+                config->integrator = (IntegratorType)found;
             } else if (strcmp(key_start, "integration_step") == 0) {
                 config->integration_step = (float)atof(value_start);
+            } else if (strcmp(key_start, "integration_tolerance") == 0) {
+                config->integration_tolerance = (float)atof(value_start);
+            } else if (strcmp(key_start, "integration_max_steps") == 0) {
+                config->integration_max_steps = atoi(value_start);
+                if (config->integration_max_steps < 1) config->integration_max_steps = 1;
+            } else if (strcmp(key_start, "multirate_interval") == 0) {
+                // Round down to a power of two in [1, 8]
+                int interval = atoi(value_start);
+                config->multirate_interval = 1;
+                while (config->multirate_interval < 8 && config->multirate_interval * 2 <= interval) {
+                    config->multirate_interval *= 2;
+                }
+            } else if (strcmp(key_start, "multirate_pixels") == 0) {
+                config->multirate_pixels = (float)atof(value_start);
+            } else if (strcmp(key_start, "simulation_backend") == 0) {
+                int found = -1;
+                for (int i = 0; i < SIMULATION_BACKEND_COUNT; i++) {
+                    if (strcmp(value_start, simulation_backend_names[i]) == 0) found = i;
+                }
+                if (found < 0) {
+                    printf("Warning: Unknown simulation_backend '%s', using cpu\n", value_start);
+                    found = SIMULATION_CPU;
+                }
+                config->simulation_backend = (SimulationBackend)found;
             } else if (strcmp(key_start, "simulation_speed") == 0) {
                 config->simulation_speed = (float)atof(value_start);
+            } else if (strcmp(key_start, "simulation_rate") == 0) {
+                config->simulation_rate = (float)atof(value_start);
+                if (config->simulation_rate < 1.0f) config->simulation_rate = 1.0f;
+            } else if (strcmp(key_start, "max_substeps") == 0) {
+                config->max_substeps = atoi(value_start);
+                if (config->max_substeps < 1) config->max_substeps = 1;
+            } else if (strcmp(key_start, "sort_interval") == 0) {
+                config->sort_interval = atoi(value_start);
+                if (config->sort_interval < 0) config->sort_interval = 0;
+            } else if (strcmp(key_start, "sort_disorder") == 0) {
+                config->sort_disorder = (float)atof(value_start);
+            } else if (strcmp(key_start, "threads") == 0) {
+                config->threads = atoi(value_start);
+            } else if (strcmp(key_start, "random_seed") == 0) {
+                config->random_seed = (unsigned int)strtoul(value_start, NULL, 10);
+            } else if (strcmp(key_start, "render_backend") == 0) {
+                int found = -1;
+                for (int i = 0; i < RENDER_BACKEND_COUNT; i++) {
+                    if (strcmp(value_start, render_backend_names[i]) == 0) found = i;
+                }
+                if (found < 0) {
+                    printf("Warning: Unknown render_backend '%s', using opengl\n", value_start);
+                    found = RENDER_BACKEND_OPENGL;
+                }
+                config->render_backend = (RenderBackend)found;
+            } else if (strcmp(key_start, "render_mode") == 0) {
+                int found = -1;
+                for (int i = 0; i < RENDER_MODE_COUNT; i++) {
+                    if (strcmp(value_start, render_mode_names[i]) == 0) found = i;
+                }
+                if (found < 0) {
+                    printf("Warning: Unknown render_mode '%s', using lines\n", value_start);
+                    found = RENDER_LINES;
+                }
+                config->render_mode = (RenderMode)found;
+            } else if (strcmp(key_start, "fused_emit") == 0) {
+                config->fused_emit = strcmp(value_start, "on") == 0;
+            } else if (strcmp(key_start, "render_scale") == 0) {
+                config->render_scale = (float)atof(value_start);
             } else if (strcmp(key_start, "trail_length") == 0) {
                 config->trail_length = atoi(value_start);
             } else if (strcmp(key_start, "background_color") == 0) {
@@ -144,15 +312,34 @@ bool config_save_to_file(const Config* config, const char* filename) {
     
     fprintf(file, "# Vector Field Settings\n");
     fprintf(file, "vector_field_num = %d\n", config->vector_field_num);
-    fprintf(file, "field_scale = %.2f\n\n", config->field_scale);
+    fprintf(file, "field_scale = %.2f\n", config->field_scale);
+    fprintf(file, "math_precision = %s\n", config_math_precision_name(config->math_precision));
+    fprintf(file, "field_cache = %s\n", config_field_cache_name(config->field_cache));
+    fprintf(file, "flow_map = %s\n\n", config->flow_map ? "on" : "off");
     
     fprintf(file, "# Integration Settings\n");
-    fprintf(file, "integration_step = %.4f\n\n", config->integration_step);
+    fprintf(file, "integrator = %s\n", config_integrator_name(config->integrator));
+    fprintf(file, "integration_step = %.4f\n", config->integration_step);
+    fprintf(file, "integration_tolerance = %.4f\n", config->integration_tolerance);
+    fprintf(file, "integration_max_steps = %d\n", config->integration_max_steps);
+    fprintf(file, "multirate_interval = %d\n", config->multirate_interval);
+    fprintf(file, "multirate_pixels = %.2f\n\n", config->multirate_pixels);
     
     fprintf(file, "# Simulation Settings\n");
-    fprintf(file, "simulation_speed = %.2f\n\n", config->simulation_speed);
+    fprintf(file, "simulation_backend = %s\n", config_simulation_backend_name(config->simulation_backend));
+    fprintf(file, "simulation_speed = %.2f\n", config->simulation_speed);
+    fprintf(file, "simulation_rate = %.2f\n", config->simulation_rate);
+    fprintf(file, "max_substeps = %d\n", config->max_substeps);
+    fprintf(file, "sort_interval = %d\n", config->sort_interval);
+    fprintf(file, "sort_disorder = %.2f\n", config->sort_disorder);
+    fprintf(file, "threads = %d\n", config->threads);
+    fprintf(file, "random_seed = %u\n\n", config->random_seed);
     
     fprintf(file, "# Rendering Settings\n");
+    fprintf(file, "render_backend = %s\n", config_render_backend_name(config->render_backend));
+    fprintf(file, "render_mode = %s\n", config_render_mode_name(config->render_mode));
+    fprintf(file, "fused_emit = %s\n", config->fused_emit ? "on" : "off");
+    fprintf(file, "render_scale = %.2f\n", config->render_scale);
     fprintf(file, "trail_length = %d\n", config->trail_length);
     fprintf(file, "background_color = %.2f,%.2f,%.2f,%.2f\n",
             config->background_color[0], config->background_color[1],
@@ -171,11 +358,25 @@ void config_print(const Config* config) {
     printf("Particle Color: (%.2f, %.2f, %.2f, %.2f)\n",
            config->particle_color[0], config->particle_color[1],
            config->particle_color[2], config->particle_color[3]);
-    printf("Vector Field: %d (scale: %.2f)\n",
-           config->vector_field_num, config->field_scale);
-    printf("Integration: step=%.4f\n",
-           config->integration_step);
-    printf("Simulation Speed: %.2f\n", config->simulation_speed);
+    printf("Vector Field: %d (scale: %.2f, math: %s, cache: %s, flow map: %s)\n",
+           config->vector_field_num, config->field_scale,
+           config_math_precision_name(config->math_precision),
+           config_field_cache_name(config->field_cache), config->flow_map ? "on" : "off");
+    printf("Integration: %s, step=%.4f (tolerance: %.4f px, max steps: %d)\n",
+           config_integrator_name(config->integrator), config->integration_step,
+           config->integration_tolerance, config->integration_max_steps);
+    printf("Multirate: up to every %d steps (%.2f px per step)\n",
+           config->multirate_interval, config->multirate_pixels);
+    printf("Simulation: %s, speed %.2f (threads: %d, seed: %u)\n",
+           config_simulation_backend_name(config->simulation_backend),
+           config->simulation_speed, config->threads, config->random_seed);
+    printf("Simulation Rate: %.2f Hz (max substeps: %d)\n",
+           config->simulation_rate, config->max_substeps);
+    printf("Spatial Sort: every %d steps (early at disorder %.2f)\n",
+           config->sort_interval, config->sort_disorder);
+    printf("Render Backend: %s\n", config_render_backend_name(config->render_backend));
+    printf("Render Mode: %s (fused emit: %s, scale: %.2f)\n", config_render_mode_name(config->render_mode),
+           config->fused_emit ? "on" : "off", config->render_scale);
     printf("Trail Length: %d\n", config->trail_length);
     printf("Background Color: (%.2f, %.2f, %.2f, %.2f)\n",
            config->background_color[0], config->background_color[1],
@@ -3,6 +3,52 @@
 
 #include <stdbool.h>
 
+// Accuracy tier of the SIMD math used by field kernels
+typedef enum {
+    MATH_PRECISION_VISUAL,     // ~1e-4 relative error, fastest
+    MATH_PRECISION_REFERENCE,  // Within a few ulp of libm
+    MATH_PRECISION_COUNT
+} MathPrecision;
+
+// Particle integration scheme
+typedef enum {
+    INTEGRATOR_EULER,
+    INTEGRATOR_MIDPOINT,
+    INTEGRATOR_RK4,
+    INTEGRATOR_RK45,      // Adaptive Dormand-Prince, per-particle step control
+    INTEGRATOR_COUNT
+} IntegratorType;
+
+// Field evaluation: exact, or interpolated from cached tiles of samples
+typedef enum {
+    FIELD_CACHE_OFF,
+    FIELD_CACHE_BILINEAR,
+    FIELD_CACHE_BICUBIC,  // Catmull-Rom
+    FIELD_CACHE_COUNT
+} FieldCacheMode;
+
+// How particle segments are drawn
+typedef enum {
+    RENDER_LINES,  // Two vertices per particle, GL_LINES
+    RENDER_QUADS,  // One instance per particle, expanded to a quad particle_size pixels wide
+    RENDER_MODE_COUNT
+} RenderMode;
+
+// What draws the particles
+typedef enum {
+    RENDER_BACKEND_OPENGL,    // Accumulation framebuffers and shaders
+    RENDER_BACKEND_SOFTWARE,  // Tiled CPU rasterizer, shown through RGFW's software buffer
+    RENDER_BACKEND_COUNT
+} RenderBackend;
+
+// Where particles are integrated
+typedef enum {
+    SIMULATION_CPU,  // Worker pool; the frame's vertices are streamed to the GPU
+    SIMULATION_GPU,  // GL 4.3 compute shaders (transform feedback below); state never leaves the GPU
+    SIMULATION_FEEDBACK,  // GL 3.3 transform feedback, even where compute shaders exist
+    SIMULATION_BACKEND_COUNT
+} SimulationBackend;
+
 // Configuration structure
 typedef struct {
     // Window settings
@@ -20,17 +66,36 @@ typedef struct {
     // Vector field settings
     int vector_field_num;
     float field_scale;
+    MathPrecision math_precision;
+    FieldCacheMode field_cache;
+    bool flow_map;  // Advance by precomputed one-step displacements (steady fields)
     
     // Integration settings
+    IntegratorType integrator;
     float integration_step;
+    float integration_tolerance;  // RK45 local error limit, in pixels
+    int integration_max_steps;    // RK45 steps per particle per frame
+    int multirate_interval;       // Longest step of slow particles, in frames (1, 2, 4 or 8)
+    float multirate_pixels;       // Distance a particle may cover in one multirate step
     
     // Simulation settings
+    SimulationBackend simulation_backend;
     float simulation_speed;
+    float simulation_rate;  // Fixed simulation steps per second of wall time
+    int max_substeps;       // Steps per rendered frame before falling behind
+    int sort_interval;      // Steps between spatial sorts while field_cache or flow_map is on (0 = never)
+    float sort_disorder;    // Sort early once this fraction of neighbors is scattered
     bool paused;
+    int threads;  // Worker threads for the update (0 = one per CPU)
+    unsigned int random_seed;  // Particle RNG seed (0 = from the clock)
     
     // Rendering settings
+    RenderBackend render_backend;  // Picked at startup
+    RenderMode render_mode;
+    bool fused_emit;  // The last update step of a frame writes the vertices itself
+    float render_scale;  // Accumulation buffer resolution relative to the window (0.25 - 1)
     float background_color[4];
-    int trail_length;
+    int trail_length;  // Positions per particle trail, up to 64 (below 2 = fading framebuffer)
     
 } Config;
 
@@ -39,5 +104,11 @@ Config config_create_default();
 bool config_load_from_file(Config* config, const char* filename);
 bool config_save_to_file(const Config* config, const char* filename);
 void config_print(const Config* config);
+const char* config_math_precision_name(MathPrecision precision);
+const char* config_integrator_name(IntegratorType integrator);
+const char* config_field_cache_name(FieldCacheMode mode);
+const char* config_render_mode_name(RenderMode mode);
+const char* config_render_backend_name(RenderBackend backend);
+const char* config_simulation_backend_name(SimulationBackend backend);
 
 #endif // CONFIG_H
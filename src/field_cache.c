@@ -0,0 +1,313 @@
+#include "field_cache.h"
+#include "simd.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Points per exact fallback batch
+#define FIELD_CACHE_BATCH 256
+
+// Interpolation kernels of each ISA (field_cache_simd.c)
+#define FIELD_CACHE_DECLARE_KERNELS(suffix) \
+    void SIMD_NAME_ISA(field_cache_bilinear, suffix)(const FieldCache* cache, const float* x, const float* y, \
+                                                     float* vx, float* vy, int32_t* index, int n); \
+    void SIMD_NAME_ISA(field_cache_bicubic, suffix)(const FieldCache* cache, const float* x, const float* y, \
+                                                    float* vx, float* vy, int32_t* index, int n);
+
+FIELD_CACHE_DECLARE_KERNELS(SIMD_SUFFIX)
+#if defined(__x86_64__)
+FIELD_CACHE_DECLARE_KERNELS(avx2)
+FIELD_CACHE_DECLARE_KERNELS(avx512)
+#endif
+
+// =============================================================================
+// Tile Table
+// =============================================================================
+
+static inline uint32_t float_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static inline unsigned int tile_hash(const FieldCacheKey* key, int tx, int ty) {
+    uint32_t h = (uint32_t)tx * 73856093u ^ (uint32_t)ty * 19349663u ^ (uint32_t)key->level * 83492791u;
+    h ^= (uint32_t)key->field * 2654435761u ^ key->scale_bits ^ key->dt_bits ^ (uint32_t)key->precision << 28;
+    h ^= h >> 15;
+    return h & (FIELD_CACHE_BUCKETS - 1);
+}
+
+static inline bool tile_matches(const FieldCacheTile* tile, const FieldCacheKey* key, int tx, int ty) {
+    return tile->tx == tx && tile->ty == ty && tile->key.level == key->level &&
+           tile->key.field == key->field && tile->key.scale_bits == key->scale_bits &&
+           tile->key.precision == key->precision && tile->key.dt_bits == key->dt_bits;
+}
+
+static int tile_find(const FieldCache* cache, const FieldCacheKey* key, int tx, int ty) {
+    for (int t = cache->buckets[tile_hash(key, tx, ty)]; t >= 0; t = cache->tiles[t].next) {
+        if (tile_matches(&cache->tiles[t], key, tx, ty)) return t;
+    }
+    return -1;
+}
+
+static void tile_unlink(FieldCache* cache, int t) {
+    FieldCacheTile* tile = &cache->tiles[t];
+    int* link = &cache->buckets[tile_hash(&tile->key, tile->tx, tile->ty)];
+    while (*link != t) link = &cache->tiles[*link].next;
+    *link = tile->next;
+}
+
+// Free slot, or the least recently used tile not needed by this prepare
+// (-1 when every tile is in use)
+static int tile_allocate(FieldCache* cache) {
+    if (cache->tile_count < FIELD_CACHE_MAX_TILES) return cache->tile_count++;
+
+    int oldest = -1;
+    for (int t = 0; t < cache->tile_count; t++) {
+        unsigned int used = cache->tiles[t].last_used;
+        if (used == cache->generation) continue;
+        if (oldest < 0 || cache->generation - used > cache->generation - cache->tiles[oldest].last_used) {
+            oldest = t;
+        }
+    }
+    if (oldest >= 0) tile_unlink(cache, oldest);
+    return oldest;
+}
+
+// =============================================================================
+// Tile Building
+// =============================================================================
+
+// Exact samples at n <= FIELD_CACHE_BATCH points: the field velocity, or
+// the displacement after one flow map step
+static void sample_exact(const FieldCache* cache, const float* x, const float* y,
+                         float* out_x, float* out_y, int n) {
+    if (!cache->flow_map) {
+        vector_field_evaluate_batch(&cache->exact, x, y, out_x, out_y, n);
+        return;
+    }
+
+    float speed[FIELD_CACHE_BATCH], step[FIELD_CACHE_BATCH];
+    memcpy(out_x, x, sizeof(float) * n);
+    memcpy(out_y, y, sizeof(float) * n);
+    memset(step, 0, sizeof(float) * n);
+    integrator_advance_batch(&cache->flow, &cache->exact, out_x, out_y, speed, step, n);
+    for (int i = 0; i < n; i++) {
+        out_x[i] -= x[i];
+        out_y[i] -= y[i];
+    }
+}
+
+// One task element = one sample row of one pending tile
+static void build_rows_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    FieldCache* cache = (FieldCache*)ctx;
+    float spacing = 1.0f / cache->inv_spacing;
+    float x[FIELD_CACHE_SAMPLES], y[FIELD_CACHE_SAMPLES];
+    float vx[FIELD_CACHE_SAMPLES], vy[FIELD_CACHE_SAMPLES];
+
+    for (int r = begin; r < end; r++) {
+        FieldCacheTile* tile = &cache->tiles[cache->pending[r / FIELD_CACHE_SAMPLES]];
+        int j = r % FIELD_CACHE_SAMPLES;
+        int gx = tile->tx * FIELD_CACHE_TILE - 1;
+        float sy = (float)(tile->ty * FIELD_CACHE_TILE + j - 1) * spacing;
+
+        for (int i = 0; i < FIELD_CACHE_SAMPLES; i++) {
+            x[i] = (float)(gx + i) * spacing;
+            y[i] = sy;
+        }
+        sample_exact(cache, x, y, vx, vy, FIELD_CACHE_SAMPLES);
+
+        float (*row)[2] = tile->v + j * FIELD_CACHE_SAMPLES;
+        for (int i = 0; i < FIELD_CACHE_SAMPLES; i++) {
+            row[i][0] = vx[i];
+            row[i][1] = vy[i];
+        }
+    }
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+FieldCache* field_cache_create(ThreadPool* pool) {
+    FieldCache* cache = (FieldCache*)calloc(1, sizeof(FieldCache));
+    if (!cache) {
+        fprintf(stderr, "Error: Failed to allocate field cache\n");
+        return NULL;
+    }
+
+    cache->tiles = (FieldCacheTile*)malloc(sizeof(FieldCacheTile) * FIELD_CACHE_MAX_TILES);
+    if (!cache->tiles) {
+        fprintf(stderr, "Error: Failed to allocate field cache tiles\n");
+        free(cache);
+        return NULL;
+    }
+
+    for (int b = 0; b < FIELD_CACHE_BUCKETS; b++) {
+        cache->buckets[b] = -1;
+    }
+    cache->pool = pool;
+
+    cache->lookup[FIELD_CACHE_BILINEAR] = SIMD_NAME(field_cache_bilinear);
+    cache->lookup[FIELD_CACHE_BICUBIC] = SIMD_NAME(field_cache_bicubic);
+#if defined(__x86_64__)
+    if (vector_field_detect_simd() == SIMD_ISA_AVX512) {
+        cache->lookup[FIELD_CACHE_BILINEAR] = SIMD_NAME_ISA(field_cache_bilinear, avx512);
+        cache->lookup[FIELD_CACHE_BICUBIC] = SIMD_NAME_ISA(field_cache_bicubic, avx512);
+    } else if (vector_field_detect_simd() == SIMD_ISA_AVX2) {
+        cache->lookup[FIELD_CACHE_BILINEAR] = SIMD_NAME_ISA(field_cache_bilinear, avx2);
+        cache->lookup[FIELD_CACHE_BICUBIC] = SIMD_NAME_ISA(field_cache_bicubic, avx2);
+    }
+#endif
+    return cache;
+}
+
+// Point the view grid at the tiles of `key` over [left, right] x [bottom, top]
+// and build up to FIELD_CACHE_BUILD_BUDGET missing ones
+static void prepare_tiles(FieldCache* cache, FieldCacheKey key, float left, float right,
+                          float bottom, float top, float world_per_pixel, float pixels) {
+    cache->generation++;
+    cache->exact.cache = NULL;
+
+    // Resolution level: power-of-two spacing at most `pixels` pixels,
+    // coarsened until the view fits in the tile budget
+    key.level = (int)ceilf(-log2f(world_per_pixel * pixels));
+    for (;;) {
+        float tile_size = ldexpf((float)FIELD_CACHE_TILE, -key.level);
+        cache->grid_x = (int)floorf(left / tile_size);
+        cache->grid_y = (int)floorf(bottom / tile_size);
+        cache->grid_w = (int)floorf(right / tile_size) - cache->grid_x + 1;
+        cache->grid_h = (int)floorf(top / tile_size) - cache->grid_y + 1;
+        if (cache->grid_w * cache->grid_h <= FIELD_CACHE_MAX_TILES) break;
+        key.level--;
+    }
+    cache->inv_spacing = ldexpf(1.0f, key.level);
+
+    // Reuse tiles built for earlier views, queue the missing ones
+    cache->pending_count = 0;
+    for (int gy = 0; gy < cache->grid_h; gy++) {
+        for (int gx = 0; gx < cache->grid_w; gx++) {
+            int tx = cache->grid_x + gx;
+            int ty = cache->grid_y + gy;
+            int t = tile_find(cache, &key, tx, ty);
+
+            if (t < 0 && cache->pending_count < FIELD_CACHE_BUILD_BUDGET &&
+                (t = tile_allocate(cache)) >= 0) {
+                FieldCacheTile* tile = &cache->tiles[t];
+                tile->key = key;
+                tile->tx = tx;
+                tile->ty = ty;
+
+                unsigned int b = tile_hash(&key, tx, ty);
+                tile->next = cache->buckets[b];
+                cache->buckets[b] = t;
+                cache->pending[cache->pending_count++] = t;
+            }
+
+            float offset = -1.0f;
+            if (t >= 0) {
+                cache->tiles[t].last_used = cache->generation;
+                offset = (float)(((size_t)t * sizeof(FieldCacheTile) + offsetof(FieldCacheTile, v)) / sizeof(float));
+            }
+            cache->grid_offset[gy * cache->grid_w + gx] = offset;
+        }
+    }
+
+    if (cache->pending_count > 0) {
+        thread_pool_run(cache->pool, cache->pending_count * FIELD_CACHE_SAMPLES, FIELD_CACHE_SAMPLES,
+                        build_rows_chunk, cache);
+    }
+}
+
+void field_cache_prepare(FieldCache* cache, const Config* config, const VectorFieldEvaluator* exact,
+                         float left, float right, float bottom, float top, float world_per_pixel) {
+    FieldCacheKey key = {config->vector_field_num, float_bits(config->field_scale),
+                         config->math_precision, 0, 0};
+    cache->mode = config->field_cache;
+    cache->exact = *exact;
+    cache->flow_map = false;
+    prepare_tiles(cache, key, left, right, bottom, top, world_per_pixel, FIELD_CACHE_PIXELS);
+}
+
+void field_cache_prepare_flow(FieldCache* cache, const Config* config, const VectorFieldEvaluator* exact,
+                              const IntegratorParams* flow,
+                              float left, float right, float bottom, float top, float world_per_pixel) {
+    FieldCacheKey key = {config->vector_field_num, float_bits(config->field_scale),
+                         config->math_precision, float_bits(flow->dt), 0};
+
+    // Displacements are smooth at the sample spacing; bicubic only on request
+    cache->mode = config->field_cache == FIELD_CACHE_BICUBIC ? FIELD_CACHE_BICUBIC : FIELD_CACHE_BILINEAR;
+    cache->exact = *exact;
+    cache->flow_map = true;
+    cache->flow = *flow;
+    prepare_tiles(cache, key, left, right, bottom, top, world_per_pixel, FIELD_CACHE_FLOW_PIXELS);
+}
+
+void field_cache_evaluate(const FieldCache* cache, const float* x, const float* y,
+                          float* vx, float* vy, int n) {
+    int32_t index[FIELD_CACHE_BATCH];
+    int misses[FIELD_CACHE_BATCH];
+    float miss_x[FIELD_CACHE_BATCH], miss_y[FIELD_CACHE_BATCH];
+    float miss_vx[FIELD_CACHE_BATCH], miss_vy[FIELD_CACHE_BATCH];
+    FieldCacheLookupFunc lookup = cache->lookup[cache->mode];
+
+    for (int base = 0; base < n; base += FIELD_CACHE_BATCH) {
+        int count = n - base < FIELD_CACHE_BATCH ? n - base : FIELD_CACHE_BATCH;
+        lookup(cache, x + base, y + base, vx + base, vy + base, index, count);
+
+        // Points outside the tiles are evaluated exactly
+        int miss_count = 0;
+        for (int i = 0; i < count; i++) {
+            if (index[i] < 0) misses[miss_count++] = base + i;
+        }
+        if (miss_count > 0) {
+            for (int m = 0; m < miss_count; m++) {
+                miss_x[m] = x[misses[m]];
+                miss_y[m] = y[misses[m]];
+            }
+            sample_exact(cache, miss_x, miss_y, miss_vx, miss_vy, miss_count);
+            for (int m = 0; m < miss_count; m++) {
+                vx[misses[m]] = miss_vx[m];
+                vy[misses[m]] = miss_vy[m];
+            }
+        }
+    }
+}
+
+void field_cache_advance(const FieldCache* cache, float* restrict x, float* restrict y,
+                         float* restrict speed, int n) {
+    float dx[FIELD_CACHE_BATCH], dy[FIELD_CACHE_BATCH];
+    float inv_dt = cache->flow.dt != 0.0f ? 1.0f / cache->flow.dt : 0.0f;
+
+    for (int base = 0; base < n; base += FIELD_CACHE_BATCH) {
+        int count = n - base < FIELD_CACHE_BATCH ? n - base : FIELD_CACHE_BATCH;
+        field_cache_evaluate(cache, x + base, y + base, dx, dy, count);
+
+        // particle_speed of the mean velocity d / dt
+        vf speed_scale = vf_set1(0.25f * inv_dt * inv_dt);
+        int full = SIMD_FLOOR(count);
+        for (int i = 0; i < full; i += SIMD_WIDTH) {
+            vf ddx = vf_load(dx + i);
+            vf ddy = vf_load(dy + i);
+            vf_store(x + base + i, vf_add(vf_load(x + base + i), ddx));
+            vf_store(y + base + i, vf_add(vf_load(y + base + i), ddy));
+            vf speed_sq = vf_fmadd(ddx, ddx, vf_mul(ddy, ddy));
+            vf_store(speed + base + i, vf_min(vf_mul(speed_sq, speed_scale), vf_set1(1.0f)));
+        }
+        for (int i = full; i < count; i++) {
+            x[base + i] += dx[i];
+            y[base + i] += dy[i];
+            speed[base + i] = particle_speed(dx[i] * inv_dt, dy[i] * inv_dt);
+        }
+    }
+}
+
+void field_cache_destroy(FieldCache* cache) {
+    if (!cache) return;
+    free(cache->tiles);
+    free(cache);
+}
@@ -0,0 +1,112 @@
+#ifndef FIELD_CACHE_H
+#define FIELD_CACHE_H
+
+#include "config.h"
+#include "vector_field.h"
+#include "integrator.h"
+#include "thread_pool.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cells per tile side. Samples add a one-sample apron on every side, so a
+// bicubic stencil never leaves its tile.
+#define FIELD_CACHE_TILE 32
+#define FIELD_CACHE_SAMPLES (FIELD_CACHE_TILE + 3)
+
+// Tiles kept in memory (~10 KB each); the least recently used one is
+// rebuilt when a new tile is needed
+#define FIELD_CACHE_MAX_TILES 512
+#define FIELD_CACHE_BUCKETS 1024
+
+// Tiles built per prepare. The rest of the view is evaluated exactly until
+// later prepares build its tiles, so zooming never stalls a frame.
+#define FIELD_CACHE_BUILD_BUDGET 64
+
+// Target sample spacing in screen pixels; picks the resolution level.
+// Flow map displacements are smoother than velocities (they scale with dt).
+#define FIELD_CACHE_PIXELS 4.0f
+#define FIELD_CACHE_FLOW_PIXELS 8.0f
+
+// What a tile was sampled from
+typedef struct {
+    int field;
+    uint32_t scale_bits;     // field_scale, bit pattern
+    MathPrecision precision;
+    uint32_t dt_bits;        // Flow map step, bit pattern (0 = velocity)
+    int level;               // Sample spacing 2^-level world units
+} FieldCacheKey;
+
+// Samples on a (FIELD_CACHE_SAMPLES)^2 lattice. Sample (i, j) sits at
+// ((tx * FIELD_CACHE_TILE + i - 1) * h, (ty * FIELD_CACHE_TILE + j - 1) * h)
+// with spacing h = 2^-level world units.
+typedef struct {
+    FieldCacheKey key;
+    int tx, ty;
+
+    int next;                // Hash chain (-1 = end)
+    unsigned int last_used;  // Prepare that last needed this tile
+    float v[FIELD_CACHE_SAMPLES * FIELD_CACHE_SAMPLES][2];  // (x, y), row-major
+} FieldCacheTile;
+
+struct FieldCache;
+
+// Interpolation kernel (see field_cache_simd.c): (vx[i], vy[i]) at n points,
+// index[i] < 0 where the point has no tile
+typedef void (*FieldCacheLookupFunc)(const struct FieldCache* cache, const float* x, const float* y,
+                                     float* vx, float* vy, int32_t* index, int n);
+
+// Tiles of the active field around the camera view, holding velocities or
+// flow map displacements (the offset after one RK4 step). Tiles depend only
+// on their key, so panning reuses them and their contents don't depend on
+// the thread count.
+typedef struct FieldCache {
+    FieldCacheTile* tiles;
+    int tile_count;                        // Slots in use
+    int buckets[FIELD_CACHE_BUCKETS];      // Hash heads (-1 = empty)
+    ThreadPool* pool;                      // Builds missing tiles (may be NULL)
+
+    // Tiles covering the view, row-major from tile (grid_x, grid_y), as the
+    // float index of each tile's samples in `tiles` (exact in a float for
+    // FIELD_CACHE_MAX_TILES tiles). Negative entries fall back to exact
+    // evaluation.
+    float grid_offset[FIELD_CACHE_MAX_TILES];
+    int grid_x, grid_y, grid_w, grid_h;
+    float inv_spacing;                     // Samples per world unit
+    FieldCacheMode mode;                   // Interpolation
+    FieldCacheLookupFunc lookup[FIELD_CACHE_COUNT];  // Widest kernel per mode
+
+    VectorFieldEvaluator exact;            // Builds tiles, serves misses
+    bool flow_map;                         // Tiles hold displacements over flow.dt
+    IntegratorParams flow;
+    int pending[FIELD_CACHE_BUILD_BUDGET]; // Tiles to build in this prepare
+    int pending_count;
+    unsigned int generation;               // Bumped by every prepare
+} FieldCache;
+
+FieldCache* field_cache_create(ThreadPool* pool);
+
+// Cover [left, right] x [bottom, top] with velocity tiles of the active
+// field at a spacing of about FIELD_CACHE_PIXELS pixels, building missing
+// tiles on the pool. `exact` must not itself use a cache.
+void field_cache_prepare(FieldCache* cache, const Config* config, const VectorFieldEvaluator* exact,
+                         float left, float right, float bottom, float top, float world_per_pixel);
+
+// Same with flow map tiles: each sample holds its displacement after one
+// fixed step of `flow`
+void field_cache_prepare_flow(FieldCache* cache, const Config* config, const VectorFieldEvaluator* exact,
+                              const IntegratorParams* flow,
+                              float left, float right, float bottom, float top, float world_per_pixel);
+
+// Interpolated samples at n points; points outside the tiles are evaluated exactly
+void field_cache_evaluate(const FieldCache* cache, const float* x, const float* y,
+                          float* vx, float* vy, int n);
+
+// Flow map: advance n points by one step. speed[i] gets the normalized
+// mean speed over the step.
+void field_cache_advance(const FieldCache* cache, float* restrict x, float* restrict y,
+                         float* restrict speed, int n);
+
+void field_cache_destroy(FieldCache* cache);
+
+#endif // FIELD_CACHE_H
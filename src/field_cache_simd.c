@@ -0,0 +1,143 @@
+#include "field_cache.h"
+#include "simd.h"
+
+// Interpolation kernels of the field cache. Like the field kernels, this
+// file is compiled once more per wide ISA; field_cache.c picks the widest
+// the CPU runs.
+
+#define S2 (2 * FIELD_CACHE_SAMPLES)  // Floats per sample row
+
+// Locate SIMD_WIDTH points in the tiles: float index of the sample
+// below-left of each point (negative when it has no tile) and the
+// fractional offsets from it
+SIMD_INLINE void lookup_locate(const FieldCache* cache, vf x, vf y, vf* index, vf* fx, vf* fy) {
+    vf zero = vf_set1(0.0f);
+    vf half = vf_set1(0.5f);
+    vf tile = vf_set1((float)FIELD_CACHE_TILE);
+
+    // Position in samples from the grid origin, clamped into the grid so
+    // every lane computes an in-range cell
+    vf gx = vf_sub(vf_mul(x, vf_set1(cache->inv_spacing)), vf_set1((float)(cache->grid_x * FIELD_CACHE_TILE)));
+    vf gy = vf_sub(vf_mul(y, vf_set1(cache->inv_spacing)), vf_set1((float)(cache->grid_y * FIELD_CACHE_TILE)));
+    vf cgx = vf_min(vf_max(gx, zero), vf_set1((float)(cache->grid_w * FIELD_CACHE_TILE) - 0.5f));
+    vf cgy = vf_min(vf_max(gy, zero), vf_set1((float)(cache->grid_h * FIELD_CACHE_TILE) - 0.5f));
+    vmask outside = vf_gt(vf_add(vf_abs(vf_sub(gx, cgx)), vf_abs(vf_sub(gy, cgy))), zero);
+
+    // Both are >= 0, so rounding v - 0.5 floors them. A tie at an integer
+    // picks the sample one below with a fraction of 1, which interpolates
+    // to the same value.
+    vf cx = vi_to_vf(vf_round_vi(vf_sub(cgx, half)));
+    vf cy = vi_to_vf(vf_round_vi(vf_sub(cgy, half)));
+
+    // Tile of the cell: cx / TILE is k + j / TILE, so the bias keeps the
+    // rounding away from ties
+    vf bias = vf_set1(0.5f / FIELD_CACHE_TILE - 0.5f);
+    vf tx = vi_to_vf(vf_round_vi(vf_fmadd(cx, vf_set1(1.0f / FIELD_CACHE_TILE), bias)));
+    vf ty = vi_to_vf(vf_round_vi(vf_fmadd(cy, vf_set1(1.0f / FIELD_CACHE_TILE), bias)));
+    vi cell = vf_round_vi(vf_fmadd(ty, vf_set1((float)cache->grid_w), tx));
+    vf offset = vf_gather(cache->grid_offset, cell);
+
+    // Sample (cell - tile origin + apron) of the tile; exact in float
+    vf col = vf_add(vf_sub(cx, vf_mul(tx, tile)), vf_set1(1.0f));
+    vf row = vf_add(vf_sub(cy, vf_mul(ty, tile)), vf_set1(1.0f));
+    vf sample = vf_fmadd(row, vf_set1((float)S2), vf_fmadd(col, vf_set1(2.0f), offset));
+
+    vmask missing = vf_lt(offset, zero);
+    *index = vf_select(outside, vf_set1(-1.0f), vf_select(missing, vf_set1(-1.0f), sample));
+    *fx = vf_sub(cgx, cx);
+    *fy = vf_sub(cgy, cy);
+}
+
+// Gather index of a lane's sample; lanes without a tile read tile memory
+// that is always allocated, and are replaced by the caller
+SIMD_INLINE vi lookup_gather_index(vf index) {
+    return vf_round_vi(vf_max(index, vf_set1((float)(S2 + 2))));
+}
+
+SIMD_INLINE void lookup_bilinear(const FieldCache* cache, vf x, vf y, vf* vx, vf* vy, vf* index) {
+    const float* samples = (const float*)cache->tiles;
+    vf fx, fy;
+    lookup_locate(cache, x, y, index, &fx, &fy);
+
+    vi s00 = lookup_gather_index(*index);
+    vi s10 = vi_add(s00, vi_set1(2));
+    vi s01 = vi_add(s00, vi_set1(S2));
+    vi s11 = vi_add(s00, vi_set1(S2 + 2));
+    vi one = vi_set1(1);
+
+    vf bottom_x = vf_gather(samples, s00);
+    vf bottom_y = vf_gather(samples, vi_add(s00, one));
+    bottom_x = vf_fmadd(fx, vf_sub(vf_gather(samples, s10), bottom_x), bottom_x);
+    bottom_y = vf_fmadd(fx, vf_sub(vf_gather(samples, vi_add(s10, one)), bottom_y), bottom_y);
+
+    vf top_x = vf_gather(samples, s01);
+    vf top_y = vf_gather(samples, vi_add(s01, one));
+    top_x = vf_fmadd(fx, vf_sub(vf_gather(samples, s11), top_x), top_x);
+    top_y = vf_fmadd(fx, vf_sub(vf_gather(samples, vi_add(s11, one)), top_y), top_y);
+
+    *vx = vf_fmadd(fy, vf_sub(top_x, bottom_x), bottom_x);
+    *vy = vf_fmadd(fy, vf_sub(top_y, bottom_y), bottom_y);
+}
+
+// Catmull-Rom weights of the samples at offsets -1, 0, 1, 2 for t in [0, 1]
+SIMD_INLINE void catmull_rom_weights(vf t, vf w[4]) {
+    vf t2 = vf_mul(t, t);
+    w[0] = vf_mul(vf_fmadd(vf_fmadd(t, vf_set1(-0.5f), vf_set1(1.0f)), t, vf_set1(-0.5f)), t);
+    w[1] = vf_fmadd(vf_fmadd(t, vf_set1(1.5f), vf_set1(-2.5f)), t2, vf_set1(1.0f));
+    w[2] = vf_mul(vf_fmadd(vf_fmadd(t, vf_set1(-1.5f), vf_set1(2.0f)), t, vf_set1(0.5f)), t);
+    w[3] = vf_mul(vf_fmadd(t, vf_set1(0.5f), vf_set1(-0.5f)), t2);
+}
+
+SIMD_INLINE void lookup_bicubic(const FieldCache* cache, vf x, vf y, vf* vx, vf* vy, vf* index) {
+    const float* samples = (const float*)cache->tiles;
+    vf fx, fy, wx[4], wy[4];
+    lookup_locate(cache, x, y, index, &fx, &fy);
+    catmull_rom_weights(fx, wx);
+    catmull_rom_weights(fy, wy);
+
+    vi base = vi_sub(lookup_gather_index(*index), vi_set1(S2 + 2));
+    vf sum_x = vf_set1(0.0f), sum_y = vf_set1(0.0f);
+    for (int b = 0; b < 4; b++) {
+        vf row_x = vf_set1(0.0f), row_y = vf_set1(0.0f);
+        for (int a = 0; a < 4; a++) {
+            vi s = vi_add(base, vi_set1(b * S2 + a * 2));
+            row_x = vf_fmadd(wx[a], vf_gather(samples, s), row_x);
+            row_y = vf_fmadd(wx[a], vf_gather(samples, vi_add(s, vi_set1(1))), row_y);
+        }
+        sum_x = vf_fmadd(wy[b], row_x, sum_x);
+        sum_y = vf_fmadd(wy[b], row_y, sum_y);
+    }
+    *vx = sum_x;
+    *vy = sum_y;
+}
+
+// Kernel over n points. index[i] < 0 marks points without a tile, whose
+// vx/vy are left for exact evaluation.
+#define FIELD_CACHE_LOOKUP_IMPL(name, lookup) \
+    void SIMD_NAME(name)(const FieldCache* cache, const float* x, const float* y, \
+                         float* vx, float* vy, int32_t* index, int n) { \
+        int full = SIMD_FLOOR(n); \
+        vf ox, oy, oi; \
+        for (int i = 0; i < full; i += SIMD_WIDTH) { \
+            lookup(cache, vf_load(x + i), vf_load(y + i), &ox, &oy, &oi); \
+            vf_store(vx + i, ox); \
+            vf_store(vy + i, oy); \
+            vi_store(index + i, vf_round_vi(oi)); \
+        } \
+        if (full < n) { \
+            float tx[SIMD_WIDTH] = {0}, ty[SIMD_WIDTH] = {0}; \
+            int32_t ti[SIMD_WIDTH]; \
+            memcpy(tx, x + full, sizeof(float) * (n - full)); \
+            memcpy(ty, y + full, sizeof(float) * (n - full)); \
+            lookup(cache, vf_load(tx), vf_load(ty), &ox, &oy, &oi); \
+            vf_store(tx, ox); \
+            vf_store(ty, oy); \
+            vi_store(ti, vf_round_vi(oi)); \
+            memcpy(vx + full, tx, sizeof(float) * (n - full)); \
+            memcpy(vy + full, ty, sizeof(float) * (n - full)); \
+            memcpy(index + full, ti, sizeof(int32_t) * (n - full)); \
+        } \
+    }
+
+FIELD_CACHE_LOOKUP_IMPL(field_cache_bilinear, lookup_bilinear)
+FIELD_CACHE_LOOKUP_IMPL(field_cache_bicubic, lookup_bicubic)
@@ -2,8 +2,11 @@
 #define FIELD_COMMON_H
 
 #include "vector_field.h"
+#include "integrator.h"
+#include "simd_math.h"
 
 #include <math.h>
+#include <string.h>
 
 // Constants
 #define PI 3.14159265f
@@ -16,6 +19,11 @@ typedef struct {
     int index;
 } FieldMetadata;
 
+// Field files are compiled once per SIMD ISA (see Makefile). The baseline
+// object carries the scalar code and all registration; FIELD_SIMD_VARIANT
+// objects only contribute the FIELD_SIMD_IMPL kernel for their ISA.
+#ifndef FIELD_SIMD_VARIANT
+
 // Macro to register a field automatically
 #define REGISTER_FIELD(idx, func_name, display_name) \
     __attribute__((constructor)) \
@@ -24,9 +32,226 @@ typedef struct {
         vector_field_register(idx, func_name, display_name); \
     }
 
+// Register a batch kernel for a field (see FIELD_BATCH_IMPL)
+#define REGISTER_FIELD_BATCH(idx, func_name) \
+    __attribute__((constructor)) \
+    static void register_##func_name##_batch() { \
+        extern void vector_field_register_batch(int, VectorFieldBatchFunc); \
+        vector_field_register_batch(idx, func_name##_batch); \
+    }
+
+// Register one FIELD_SIMD_IMPL kernel (both precision tiers) for an ISA
+#define FIELD_REGISTER_SIMD_ISA(idx, func_name, isa, suffix) \
+    vector_field_register_simd(idx, isa, MATH_PRECISION_VISUAL, \
+                               SIMD_NAME_ISA(func_name##_visual, suffix)); \
+    vector_field_register_simd(idx, isa, MATH_PRECISION_REFERENCE, \
+                               SIMD_NAME_ISA(func_name##_reference, suffix));
+
+#if defined(__x86_64__)
+// Register the baseline kernels plus the AVX2/AVX-512 variant objects
+#define REGISTER_FIELD_SIMD(idx, func_name) \
+    FIELD_BATCH_IMPL(SIMD_NAME_ISA(func_name##_visual, avx2)); \
+    FIELD_BATCH_IMPL(SIMD_NAME_ISA(func_name##_reference, avx2)); \
+    FIELD_BATCH_IMPL(SIMD_NAME_ISA(func_name##_visual, avx512)); \
+    FIELD_BATCH_IMPL(SIMD_NAME_ISA(func_name##_reference, avx512)); \
+    __attribute__((constructor)) \
+    static void register_##func_name##_simd() { \
+        FIELD_REGISTER_SIMD_ISA(idx, func_name, SIMD_ISA, SIMD_SUFFIX) \
+        FIELD_REGISTER_SIMD_ISA(idx, func_name, SIMD_ISA_AVX2, avx2) \
+        FIELD_REGISTER_SIMD_ISA(idx, func_name, SIMD_ISA_AVX512, avx512) \
+    }
+#else
+#define REGISTER_FIELD_SIMD(idx, func_name) \
+    __attribute__((constructor)) \
+    static void register_##func_name##_simd() { \
+        FIELD_REGISTER_SIMD_ISA(idx, func_name, SIMD_ISA, SIMD_SUFFIX) \
+    }
+#endif
+
+// Fused integrator loops (FIELD_FUSED_UPDATE) of one field for one ISA:
+// declarations and designated initializers for integrator_fused_table
+#define FIELD_FUSED_DECLARE_ISA(func_name, suffix) \
+    FIELD_FUSED_DECLARE_TIER(func_name, visual, suffix) \
+    FIELD_FUSED_DECLARE_TIER(func_name, reference, suffix)
+#define FIELD_FUSED_DECLARE_TIER(func_name, tier, suffix) \
+    INTEGRATOR_FUSED_IMPL(SIMD_NAME_ISA(func_name##_euler_##tier, suffix)); \
+    INTEGRATOR_FUSED_IMPL(SIMD_NAME_ISA(func_name##_midpoint_##tier, suffix)); \
+    INTEGRATOR_FUSED_IMPL(SIMD_NAME_ISA(func_name##_rk4_##tier, suffix));
+
+#define FIELD_FUSED_ENTRIES_ISA(idx, func_name, isa, suffix) \
+    FIELD_FUSED_ENTRIES_TIER(idx, func_name, isa, suffix, visual, MATH_PRECISION_VISUAL) \
+    FIELD_FUSED_ENTRIES_TIER(idx, func_name, isa, suffix, reference, MATH_PRECISION_REFERENCE)
+#define FIELD_FUSED_ENTRIES_TIER(idx, func_name, isa, suffix, tier, prec) \
+    [idx][INTEGRATOR_EULER][prec][isa] = SIMD_NAME_ISA(func_name##_euler_##tier, suffix), \
+    [idx][INTEGRATOR_MIDPOINT][prec][isa] = SIMD_NAME_ISA(func_name##_midpoint_##tier, suffix), \
+    [idx][INTEGRATOR_RK4][prec][isa] = SIMD_NAME_ISA(func_name##_rk4_##tier, suffix),
+
+// Used by the generated table (tools/gen_fused_table.sh), one line per
+// REGISTER_FIELD_SIMD in src/fields
+#if defined(__x86_64__)
+#define FIELD_FUSED_DECLARE(func_name) \
+    FIELD_FUSED_DECLARE_ISA(func_name, SIMD_SUFFIX) \
+    FIELD_FUSED_DECLARE_ISA(func_name, avx2) \
+    FIELD_FUSED_DECLARE_ISA(func_name, avx512)
+#define FIELD_FUSED_ENTRIES(idx, func_name) \
+    FIELD_FUSED_ENTRIES_ISA(idx, func_name, SIMD_ISA, SIMD_SUFFIX) \
+    FIELD_FUSED_ENTRIES_ISA(idx, func_name, SIMD_ISA_AVX2, avx2) \
+    FIELD_FUSED_ENTRIES_ISA(idx, func_name, SIMD_ISA_AVX512, avx512)
+#else
+#define FIELD_FUSED_DECLARE(func_name) FIELD_FUSED_DECLARE_ISA(func_name, SIMD_SUFFIX)
+#define FIELD_FUSED_ENTRIES(idx, func_name) FIELD_FUSED_ENTRIES_ISA(idx, func_name, SIMD_ISA, SIMD_SUFFIX)
+#endif
+
 // Helper macro for field implementation
 #define FIELD_IMPL(name) vec2 name(vec2 p, float scale)
 
+// Batch kernel built from the scalar FIELD_IMPL in the same file. The scalar
+// body is visible here, so the compiler can inline it into the loop.
+#define FIELD_BATCH_FROM_SCALAR(func_name) \
+    static FIELD_BATCH_IMPL(func_name##_batch) { \
+        for (int i = 0; i < n; i++) { \
+            vec2 v = func_name((vec2){x[i], y[i]}, scale); \
+            vx[i] = v.x; \
+            vy[i] = v.y; \
+        } \
+    }
+
+#else // FIELD_SIMD_VARIANT
+
+#define REGISTER_FIELD(idx, func_name, display_name) extern int field_simd_variant_unused
+#define REGISTER_FIELD_BATCH(idx, func_name) extern int field_simd_variant_unused
+#define REGISTER_FIELD_SIMD(idx, func_name) extern int field_simd_variant_unused
+#define FIELD_IMPL(name) static inline vec2 name##_unused(vec2 p, float scale)
+#define FIELD_BATCH_FROM_SCALAR(func_name)
+
+#endif // FIELD_SIMD_VARIANT
+
+// Helper macro for batch kernel implementation
+#define FIELD_BATCH_IMPL(name) \
+    void name(const float* x, const float* y, float* vx, float* vy, int n, float scale)
+
+// Batch loop around a FIELD_SIMD_IMPL kernel for one precision tier
+#define FIELD_SIMD_BATCH(name, tier, prec) \
+    FIELD_BATCH_IMPL(SIMD_NAME(name##_##tier)) { \
+        vf vscale = vf_set1(scale); \
+        int full = SIMD_FLOOR(n); \
+        vf ox, oy; \
+        for (int i = 0; i < full; i += SIMD_WIDTH) { \
+            name##_vkernel(vf_load(x + i), vf_load(y + i), vscale, prec, &ox, &oy); \
+            vf_store(vx + i, ox); \
+            vf_store(vy + i, oy); \
+        } \
+        if (full < n) { \
+            /* Tail: one zero-padded vector */ \
+            float tx[SIMD_WIDTH] = {0}, ty[SIMD_WIDTH] = {0}; \
+            memcpy(tx, x + full, sizeof(float) * (n - full)); \
+            memcpy(ty, y + full, sizeof(float) * (n - full)); \
+            name##_vkernel(vf_load(tx), vf_load(ty), vscale, prec, &ox, &oy); \
+            vf_store(tx, ox); \
+            vf_store(ty, oy); \
+            memcpy(vx + full, tx, sizeof(float) * (n - full)); \
+            memcpy(vy + full, ty, sizeof(float) * (n - full)); \
+        } \
+    }
+
+// Normalized color speed of a SIMD_WIDTH-wide derivative (particle_speed in
+// integrator.h)
+SIMD_INLINE vf field_fused_speed(vf vx, vf vy) {
+    vf speed_sq = vf_fmadd(vx, vx, vf_mul(vy, vy));
+    return vf_min(vf_mul(speed_sq, vf_set1(0.25f)), vf_set1(1.0f));
+}
+
+// Fixed-step explicit Runge-Kutta tableaus for the fused loops. Stage s is
+// evaluated at x + C[s] * dt * k[s-1]; the step is x += dt * SCALE * sum(W[s] * k[s]).
+#define FIELD_FUSED_euler_STAGES 1
+#define FIELD_FUSED_euler_C { 0.0f }
+#define FIELD_FUSED_euler_W { 1.0f }
+#define FIELD_FUSED_euler_SCALE 1.0f
+
+#define FIELD_FUSED_midpoint_STAGES 2
+#define FIELD_FUSED_midpoint_C { 0.0f, 0.5f }
+#define FIELD_FUSED_midpoint_W { 0.0f, 1.0f }
+#define FIELD_FUSED_midpoint_SCALE 1.0f
+
+#define FIELD_FUSED_rk4_STAGES 4
+#define FIELD_FUSED_rk4_C { 0.0f, 0.5f, 0.5f, 1.0f }
+#define FIELD_FUSED_rk4_W { 1.0f, 2.0f, 2.0f, 1.0f }
+#define FIELD_FUSED_rk4_SCALE 0.16666667f
+
+// Whole-batch integrator step with the field kernel inlined: every stage of a
+// vector of particles runs in registers, with no call per field evaluation.
+// The stage loop has a single kernel call site, so the kernel is inlined once
+// per integrator; the tail runs the same body on a zero-padded copy.
+#define FIELD_FUSED_UPDATE(name, integ, tier, prec) \
+    INTEGRATOR_FUSED_IMPL(SIMD_NAME(name##_##integ##_##tier)) { \
+        static const float c[] = FIELD_FUSED_##integ##_C; \
+        static const float w[] = FIELD_FUSED_##integ##_W; \
+        float hc[FIELD_FUSED_##integ##_STAGES]; \
+        for (int s = 0; s < FIELD_FUSED_##integ##_STAGES; s++) { \
+            hc[s] = c[s] * dt; \
+        } \
+        vf vscale = vf_set1(scale); \
+        vf hw = vf_set1(dt * FIELD_FUSED_##integ##_SCALE); \
+        float tx[SIMD_WIDTH], ty[SIMD_WIDTH], ts[SIMD_WIDTH]; \
+        for (int i = 0; i < n; i += SIMD_WIDTH) { \
+            float* bx = x + i; \
+            float* by = y + i; \
+            float* bs = speed + i; \
+            int tail = n - i < SIMD_WIDTH ? n - i : 0; \
+            if (tail) { \
+                memset(tx, 0, sizeof(tx)); \
+                memset(ty, 0, sizeof(ty)); \
+                memcpy(tx, bx, sizeof(float) * tail); \
+                memcpy(ty, by, sizeof(float) * tail); \
+                bx = tx; \
+                by = ty; \
+                bs = ts; \
+            } \
+            vf px = vf_load(bx), py = vf_load(by); \
+            vf sx = px, sy = py, kx = px, ky = py; \
+            vf ax = vf_set1(0.0f), ay = vf_set1(0.0f); \
+            for (int s = 0; s < FIELD_FUSED_##integ##_STAGES; s++) { \
+                if (s > 0) { \
+                    sx = vf_fmadd(kx, vf_set1(hc[s]), px); \
+                    sy = vf_fmadd(ky, vf_set1(hc[s]), py); \
+                } \
+                name##_vkernel(sx, sy, vscale, prec, &kx, &ky); \
+                if (s == 0) vf_store(bs, field_fused_speed(kx, ky)); \
+                ax = vf_fmadd(kx, vf_set1(w[s]), ax); \
+                ay = vf_fmadd(ky, vf_set1(w[s]), ay); \
+            } \
+            vf_store(bx, vf_fmadd(ax, hw, px)); \
+            vf_store(by, vf_fmadd(ay, hw, py)); \
+            if (tail) { \
+                memcpy(x + i, tx, sizeof(float) * tail); \
+                memcpy(y + i, ty, sizeof(float) * tail); \
+                memcpy(speed + i, ts, sizeof(float) * tail); \
+            } \
+        } \
+    }
+
+#define FIELD_FUSED_UPDATES(name, tier, prec) \
+    FIELD_FUSED_UPDATE(name, euler, tier, prec) \
+    FIELD_FUSED_UPDATE(name, midpoint, tier, prec) \
+    FIELD_FUSED_UPDATE(name, rk4, tier, prec)
+
+// SIMD kernel: the body computes (*out_x, *out_y) for SIMD_WIDTH points
+// (px, py) at once using simd.h/simd_math.h, passing `prec` to every vm_*
+// call. The macro emits one batch loop and one fused loop per fixed-step
+// integrator for each precision tier, named after the integrator, the tier
+// and the ISA this object is compiled for. Polynomial fields ignore `prec`.
+#define FIELD_SIMD_KERNEL_SIGNATURE(name) \
+    SIMD_INLINE void name##_vkernel(vf px, vf py, vf scale, \
+                                    MathPrecision prec __attribute__((unused)), vf* out_x, vf* out_y)
+
+#define FIELD_SIMD_IMPL(name) \
+    FIELD_SIMD_KERNEL_SIGNATURE(name); \
+    FIELD_SIMD_BATCH(name, visual, MATH_PRECISION_VISUAL) \
+    FIELD_SIMD_BATCH(name, reference, MATH_PRECISION_REFERENCE) \
+    FIELD_FUSED_UPDATES(name, visual, MATH_PRECISION_VISUAL) \
+    FIELD_FUSED_UPDATES(name, reference, MATH_PRECISION_REFERENCE) \
+    FIELD_SIMD_KERNEL_SIGNATURE(name)
+
 // Common helper functions
 static inline float safe_length(vec2 v) {
     return sqrtf(v.x * v.x + v.y * v.y);
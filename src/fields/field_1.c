@@ -10,5 +10,16 @@ FIELD_IMPL(field_1) {
     return v;
 }
 
+FIELD_BATCH_FROM_SCALAR(field_1)
+
+FIELD_SIMD_IMPL(field_1) {
+    vf k = vf_mul(vf_set1(0.05f), scale);
+    vf r_squared = vf_fmadd(px, px, vf_mul(py, py));
+    *out_x = vf_mul(vf_mul(vf_set1(10.0f), vf_sub(py, px)), k);
+    *out_y = vf_mul(vf_sub(vf_mul(px, vf_sub(vf_set1(28.0f), r_squared)), py), k);
+}
+
 // Auto-register this field at startup
-REGISTER_FIELD(0, field_1, "Lorenz Field");
\ No newline at end of file
+REGISTER_FIELD(0, field_1, "Lorenz Field");
+REGISTER_FIELD_BATCH(0, field_1);
+REGISTER_FIELD_SIMD(0, field_1);
\ No newline at end of file
@@ -8,4 +8,13 @@ FIELD_IMPL(field_2) {
     return v;
 }
 
-REGISTER_FIELD(1, field_2, "Wavy Hyperbolic");
\ No newline at end of file
+FIELD_BATCH_FROM_SCALAR(field_2)
+
+FIELD_SIMD_IMPL(field_2) {
+    *out_x = vf_mul(vm_sin(vf_fmadd(vf_set1(5.0f), py, px), prec), scale);
+    *out_y = vf_mul(vm_cos(vf_fmadd(vf_set1(5.0f), px, vf_sub(vf_set1(0.0f), py)), prec), scale);
+}
+
+REGISTER_FIELD(1, field_2, "Wavy Hyperbolic");
+REGISTER_FIELD_BATCH(1, field_2);
+REGISTER_FIELD_SIMD(1, field_2);
\ No newline at end of file
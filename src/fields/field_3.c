@@ -60,4 +60,66 @@ FIELD_IMPL(field_3) {
     return v;
 }
 
-REGISTER_FIELD(2, field_3, "Crystalline Nebula");
\ No newline at end of file
+FIELD_BATCH_FROM_SCALAR(field_3)
+
+FIELD_SIMD_IMPL(field_3) {
+    vf r = vm_sqrt(vf_fmadd(px, px, vf_mul(py, py)), prec);
+    vf theta = vm_atan2(py, px, prec);
+    
+    vf r_inv = vm_rcp(vf_add(r, vf_set1(0.5f)), prec);
+    vf r_scaled = vf_mul(r, vf_set1(4.0f));
+    
+    // 1. Hexagonal (angle1 = 0 projects onto x)
+    vf proj2 = vf_fmadd(px, vf_set1(cosf(PI / 3.0f)), vf_mul(py, vf_set1(sinf(PI / 3.0f))));
+    vf hex = vf_add(vm_cos(vf_mul(px, vf_set1(4.0f)), prec), vm_cos(vf_mul(proj2, vf_set1(4.0f)), prec));
+    hex = vf_mul(hex, vf_set1(0.1f));
+    
+    // 2. Interference
+    vf i1 = vm_sin(vf_fmadd(r, vf_set1(2.5f), theta), prec);
+    vf i2 = vm_sin(vf_fmadd(r, vf_set1(5.0f), vf_add(theta, theta)), prec);
+    vf interference = vf_mul(vf_fmadd(i2, vf_set1(0.5f), i1), vf_set1(0.1f));
+    
+    // 3. Organic flow
+    vf flow_x = vm_sin(vf_fmadd(py, vf_set1(2.0f), vm_cos(vf_mul(px, vf_set1(1.5f)), prec)), prec);
+    vf flow_y = vm_cos(vf_fmadd(px, vf_set1(2.0f), vm_sin(vf_mul(py, vf_set1(1.5f)), prec)), prec);
+    flow_x = vf_mul(flow_x, vf_set1(0.6f));
+    flow_y = vf_mul(flow_y, vf_set1(0.6f));
+    
+    // 4. Radial breathing
+    vf breath = vf_mul(vf_mul(vm_sin(vf_mul(r, vf_set1(3.0f)), prec), vm_exp(vf_mul(r, vf_set1(-0.3f)), prec)),
+                       vf_set1(0.4f));
+    
+    // 5. Tangential swirl
+    vf swirl = vf_add(vf_set1(1.0f), vm_sin(vf_fmadd(theta, vf_set1(-8.0f), r_scaled), prec));
+    swirl = vf_mul(vf_mul(swirl, vf_set1(0.5f)), r_inv);
+    
+    // 6. Fractal
+    vf fx = vf_sub(vf_abs(px), vf_set1(0.5f));
+    vf fy = vf_sub(vf_abs(py), vf_set1(0.5f));
+    vf fractal = vf_mul(vm_sin(vf_fmadd(fx, vf_set1(2.0f), fy), prec), vf_set1(0.1f));
+    
+    // Combine
+    vf sin_theta, cos_theta, sin_2r, cos_2r;
+    vm_sincos(vf_mul(theta, vf_set1(5.0f)), prec, &sin_theta, &cos_theta);
+    vm_sincos(vf_add(r, r), prec, &sin_2r, &cos_2r);
+    vf flow_mult = vf_add(vf_set1(1.0f), hex);
+    
+    vf x = vf_mul(vf_sub(vf_set1(0.0f), py), swirl);
+    x = vf_fmadd(flow_x, flow_mult, x);
+    x = vf_fmadd(cos_theta, breath, x);
+    x = vf_fmadd(interference, sin_theta, x);
+    x = vf_fmadd(fractal, cos_2r, x);
+    
+    vf y = vf_mul(px, swirl);
+    y = vf_fmadd(flow_y, flow_mult, y);
+    y = vf_fmadd(sin_theta, breath, y);
+    y = vf_fmadd(interference, cos_theta, y);
+    y = vf_fmadd(fractal, sin_2r, y);
+    
+    *out_x = vf_mul(x, scale);
+    *out_y = vf_mul(y, scale);
+}
+
+REGISTER_FIELD(2, field_3, "Crystalline Nebula");
+REGISTER_FIELD_BATCH(2, field_3);
+REGISTER_FIELD_SIMD(2, field_3);
\ No newline at end of file
@@ -10,4 +10,14 @@ FIELD_IMPL(field_4) {
     return v;
 }
 
-REGISTER_FIELD(3, field_4, "Hopf Field");
\ No newline at end of file
+FIELD_BATCH_FROM_SCALAR(field_4)
+
+FIELD_SIMD_IMPL(field_4) {
+    vf mu = vf_sub(vf_set1(1.0f), vf_fmadd(px, px, vf_mul(py, py)));
+    *out_x = vf_mul(vf_fmadd(mu, px, vf_sub(vf_set1(0.0f), py)), scale);
+    *out_y = vf_mul(vf_fmadd(mu, py, px), scale);
+}
+
+REGISTER_FIELD(3, field_4, "Hopf Field");
+REGISTER_FIELD_BATCH(3, field_4);
+REGISTER_FIELD_SIMD(3, field_4);
\ No newline at end of file
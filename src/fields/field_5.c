@@ -9,4 +9,16 @@ FIELD_IMPL(field_5) {
     return v;
 }
 
+FIELD_BATCH_FROM_SCALAR(field_5)
+
+FIELD_SIMD_IMPL(field_5) {
+    vf r = vm_sqrt(vf_fmadd(px, px, vf_mul(py, py)), prec);
+    vf s, c;
+    vm_sincos(vf_add(r, r), prec, &s, &c);
+    *out_x = vf_mul(vf_fmadd(s, vf_set1(0.3f), vf_sub(vf_set1(0.0f), py)), scale);
+    *out_y = vf_mul(vf_fmadd(c, vf_set1(0.3f), px), scale);
+}
+
 REGISTER_FIELD(4, field_5, "Radial Wave Vortex");
+REGISTER_FIELD_BATCH(4, field_5);
+REGISTER_FIELD_SIMD(4, field_5);
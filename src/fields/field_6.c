@@ -27,4 +27,26 @@ FIELD_IMPL(field_6) {
     return v;
 }
 
+FIELD_BATCH_FROM_SCALAR(field_6)
+
+FIELD_SIMD_IMPL(field_6) {
+    // sin(a + PI) = -sin(a): both vortex centers from one sine
+    vf vortex1_y = vf_mul(vm_sin(vf_add(px, px), prec), vf_set1(0.5f));
+    vf vortex2_y = vf_sub(vf_set1(0.0f), vortex1_y);
+    
+    vf d1 = vf_sub(py, vortex1_y);
+    vf d2 = vf_sub(py, vortex2_y);
+    vf x2 = vf_mul(px, px);
+    vf inv1 = vm_rcp(vf_add(vm_sqrt(vf_fmadd(d1, d1, x2), prec), vf_set1(0.1f)), prec);
+    vf inv2 = vm_rcp(vf_add(vm_sqrt(vf_fmadd(d2, d2, x2), prec), vf_set1(0.1f)), prec);
+    
+    // v1 = (-d1, x) / dist1, v2 = (d2, -x) / dist2, strength = 1
+    vf x = vf_fmadd(d2, inv2, vf_sub(vf_set1(0.5f), vf_mul(d1, inv1)));
+    vf y = vf_mul(px, vf_sub(inv1, inv2));
+    *out_x = vf_mul(x, scale);
+    *out_y = vf_mul(y, scale);
+}
+
 REGISTER_FIELD(5, field_6, "Kármán Vortex Street");
+REGISTER_FIELD_BATCH(5, field_6);
+REGISTER_FIELD_SIMD(5, field_6);
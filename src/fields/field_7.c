@@ -23,4 +23,33 @@ FIELD_IMPL(field_7) {
     return v;
 }
 
-REGISTER_FIELD(6, field_7, "Double Gyre");
\ No newline at end of file
+FIELD_BATCH_FROM_SCALAR(field_7)
+
+FIELD_SIMD_IMPL(field_7) {
+    const float A = 0.1f;
+    const float epsilon = 0.25f;
+    const float omega = TWO_PI / 10.0f;
+    
+    vf time_param = vf_fmadd(py, vf_set1(0.5f), px);
+    vf s = vm_sin(vf_mul(vf_set1(omega), time_param), prec);
+    vf a = vf_mul(vf_set1(epsilon), s);
+    vf b = vf_fmadd(vf_set1(-2.0f * epsilon), s, vf_set1(1.0f));
+    vf f = vf_mul(vf_fmadd(a, px, b), px);
+    
+    vf sin_f, cos_f, sin_y, cos_y;
+    vm_sincos(vf_mul(vf_set1(PI), f), prec, &sin_f, &cos_f);
+    vm_sincos(vf_mul(vf_set1(PI), py), prec, &sin_y, &cos_y);
+    
+    vf x = vf_mul(vf_mul(vf_set1(-PI * A), sin_f), cos_y);
+    vf y = vf_mul(vf_mul(vf_mul(vf_set1(PI * A), cos_f), sin_y), vf_fmadd(vf_add(a, a), px, b));
+    
+    x = vf_fmadd(vm_sin(vf_mul(py, vf_set1(3.0f)), prec), vf_set1(0.1f), x);
+    y = vf_fmadd(vm_cos(vf_mul(px, vf_set1(3.0f)), prec), vf_set1(0.1f), y);
+    
+    *out_x = vf_mul(x, scale);
+    *out_y = vf_mul(y, scale);
+}
+
+REGISTER_FIELD(6, field_7, "Double Gyre");
+REGISTER_FIELD_BATCH(6, field_7);
+REGISTER_FIELD_SIMD(6, field_7);
\ No newline at end of file
@@ -16,4 +16,24 @@ FIELD_IMPL(field_8) {
     return v;
 }
 
-REGISTER_FIELD(7, field_8, "Galaxy Spiral");
\ No newline at end of file
+FIELD_BATCH_FROM_SCALAR(field_8)
+
+FIELD_SIMD_IMPL(field_8) {
+    vf r = vm_sqrt(vf_fmadd(px, px, vf_mul(py, py)), prec);
+    
+    // cos/sin(atan2(y, x)) = (x, y) / r, and (1, 0) at the origin
+    vmask origin = vf_lt(r, vf_set1(1e-30f));
+    vf r_inv = vm_rcp(vf_select(origin, vf_set1(1.0f), r), prec);
+    vf cos_theta = vf_select(origin, vf_set1(1.0f), vf_mul(px, r_inv));
+    vf sin_theta = vf_select(origin, vf_set1(0.0f), vf_mul(py, r_inv));
+    
+    vf vtheta = vf_mul(vf_set1(0.5f), vm_rcp(vf_add(r, vf_set1(0.1f)), prec));
+    vf vr = vf_mul(vf_set1(-0.2f), r);
+    
+    *out_x = vf_mul(vf_sub(vf_mul(vr, cos_theta), vf_mul(vtheta, sin_theta)), scale);
+    *out_y = vf_mul(vf_fmadd(vr, sin_theta, vf_mul(vtheta, cos_theta)), scale);
+}
+
+REGISTER_FIELD(7, field_8, "Galaxy Spiral");
+REGISTER_FIELD_BATCH(7, field_8);
+REGISTER_FIELD_SIMD(7, field_8);
\ No newline at end of file
@@ -9,4 +9,15 @@ FIELD_IMPL(field_9) {
     return v;
 }
 
+FIELD_BATCH_FROM_SCALAR(field_9)
+
+FIELD_SIMD_IMPL(field_9) {
+    const float mu = 2.0f;
+    vf one_minus_x2 = vf_sub(vf_set1(1.0f), vf_mul(px, px));
+    *out_x = vf_mul(py, scale);
+    *out_y = vf_mul(vf_sub(vf_mul(vf_mul(vf_set1(mu), one_minus_x2), py), px), scale);
+}
+
 REGISTER_FIELD(8, field_9, "Van der Pol Oscillator");
+REGISTER_FIELD_BATCH(8, field_9);
+REGISTER_FIELD_SIMD(8, field_9);
@@ -0,0 +1,227 @@
+#define _POSIX_C_SOURCE 200809L  // mkdir
+#define GL_GLEXT_PROTOTYPES  // glFenceSync, glMapBufferRange, ... from glext.h
+#include "frame_capture.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Wait for a readback in 100 ms slices (see ring_wait in renderer.c)
+#define CAPTURE_WAIT_TIMEOUT 100000000ull
+
+// Write one queued RGBA frame to its file (PPM rows run top to bottom, GL's
+// bottom to top)
+static bool write_frame(FrameCapture* capture, const unsigned char* pixels, int frame) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/frame_%05d.ppm", capture->directory, frame);
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not write frame '%s'\n", path);
+        return false;
+    }
+
+    bool ok = fprintf(file, "P6\n%d %d\n255\n", capture->width, capture->height) > 0;
+    for (int y = capture->height - 1; y >= 0 && ok; y--) {
+        const unsigned char* src = pixels + (size_t)y * (size_t)capture->width * 4;
+        for (int x = 0; x < capture->width; x++) {
+            capture->row[x * 3] = src[x * 4];
+            capture->row[x * 3 + 1] = src[x * 4 + 1];
+            capture->row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        ok = fwrite(capture->row, 3, (size_t)capture->width, file) == (size_t)capture->width;
+    }
+
+    if (fclose(file) != 0) ok = false;
+    if (!ok) fprintf(stderr, "Error: Could not write frame '%s'\n", path);
+    return ok;
+}
+
+// Writer thread: write queued frames oldest first until stopped and empty.
+// An entry stays queued (and its slot taken) until its file is written.
+static void* frame_capture_writer(void* arg) {
+    FrameCapture* capture = (FrameCapture*)arg;
+
+    pthread_mutex_lock(&capture->mutex);
+    for (;;) {
+        while (capture->queued == 0 && !capture->stop) {
+            pthread_cond_wait(&capture->frame_ready, &capture->mutex);
+        }
+        if (capture->queued == 0) break;
+        int slot = capture->head;
+        pthread_mutex_unlock(&capture->mutex);
+
+        bool ok = write_frame(capture, capture->queue[slot], capture->queue_frames[slot]);
+
+        pthread_mutex_lock(&capture->mutex);
+        if (ok) {
+            capture->written++;
+        } else {
+            capture->failed = true;
+        }
+        capture->head = (capture->head + 1) % FRAME_CAPTURE_QUEUE;
+        capture->queued--;
+        pthread_cond_signal(&capture->slot_free);
+    }
+    pthread_mutex_unlock(&capture->mutex);
+    return NULL;
+}
+
+// Let the writer drain the queue, then join it
+static void stop_writer(FrameCapture* capture) {
+    if (!capture->writer_running) return;
+
+    pthread_mutex_lock(&capture->mutex);
+    capture->stop = true;
+    pthread_cond_signal(&capture->frame_ready);
+    pthread_mutex_unlock(&capture->mutex);
+
+    pthread_join(capture->writer, NULL);
+    capture->writer_running = false;
+}
+
+FrameCapture* frame_capture_create(int width, int height, const char* directory) {
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Could not create output directory '%s'\n", directory);
+        return NULL;
+    }
+
+    FrameCapture* capture = (FrameCapture*)calloc(1, sizeof(FrameCapture));
+    if (!capture) {
+        fprintf(stderr, "Error: Failed to allocate frame capture\n");
+        return NULL;
+    }
+    capture->width = width;
+    capture->height = height;
+    pthread_mutex_init(&capture->mutex, NULL);
+    pthread_cond_init(&capture->frame_ready, NULL);
+    pthread_cond_init(&capture->slot_free, NULL);
+
+    size_t size = (size_t)width * (size_t)height * 4;
+    capture->directory = (char*)malloc(strlen(directory) + 1);
+    capture->row = (unsigned char*)malloc((size_t)width * 3);
+    bool allocated = capture->directory && capture->row;
+    for (int i = 0; i < FRAME_CAPTURE_QUEUE; i++) {
+        capture->queue[i] = (unsigned char*)malloc(size);
+        if (!capture->queue[i]) allocated = false;
+    }
+    if (!allocated) {
+        fprintf(stderr, "Error: Failed to allocate frame capture\n");
+        frame_capture_destroy(capture);
+        return NULL;
+    }
+    strcpy(capture->directory, directory);
+
+    while (glGetError() != GL_NO_ERROR) {}
+    glGenBuffers(FRAME_CAPTURE_BUFFERS, capture->buffers);
+    for (int i = 0; i < FRAME_CAPTURE_BUFFERS; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->buffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        fprintf(stderr, "Error: Failed to allocate frame capture buffers\n");
+        frame_capture_destroy(capture);
+        return NULL;
+    }
+
+    if (pthread_create(&capture->writer, NULL, frame_capture_writer, capture) != 0) {
+        fprintf(stderr, "Error: Failed to start frame writer thread\n");
+        frame_capture_destroy(capture);
+        return NULL;
+    }
+    capture->writer_running = true;
+
+    printf("Frame capture: %dx%d into '%s', %d buffers\n", width, height, directory, FRAME_CAPTURE_BUFFERS);
+    return capture;
+}
+
+// Wait for buffer i's readback and copy it into the writer's queue. Only
+// the copy runs here; conversion and file I/O happen on the writer thread.
+static bool queue_buffer(FrameCapture* capture, int i) {
+    GLsync fence = capture->fences[i];
+    if (!fence) return true;
+
+    GLenum status;
+    do {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, CAPTURE_WAIT_TIMEOUT);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    glDeleteSync(fence);
+    capture->fences[i] = NULL;
+
+    // Entries past head + queued aren't touched by the writer, so the copy
+    // can go in without the lock
+    pthread_mutex_lock(&capture->mutex);
+    while (capture->queued == FRAME_CAPTURE_QUEUE) {
+        pthread_cond_wait(&capture->slot_free, &capture->mutex);
+    }
+    int slot = (capture->head + capture->queued) % FRAME_CAPTURE_QUEUE;
+    bool failed = capture->failed;
+    pthread_mutex_unlock(&capture->mutex);
+    if (failed) return false;
+
+    size_t size = (size_t)capture->width * (size_t)capture->height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->buffers[i]);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_READ_BIT);
+    if (pixels) {
+        memcpy(capture->queue[slot], pixels, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!pixels) {
+        fprintf(stderr, "Error: Could not map frame %d\n", capture->frames[i]);
+        return false;
+    }
+
+    pthread_mutex_lock(&capture->mutex);
+    capture->queue_frames[slot] = capture->frames[i];
+    capture->queued++;
+    pthread_cond_signal(&capture->frame_ready);
+    pthread_mutex_unlock(&capture->mutex);
+    return true;
+}
+
+bool frame_capture_push(FrameCapture* capture, GLuint framebuffer, int frame) {
+    int i = capture->next;
+    if (!queue_buffer(capture, i)) return false;
+
+    // Asynchronous: with a pack buffer bound, glReadPixels only queues the copy
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->buffers[i]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture->fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    capture->frames[i] = frame;
+
+    capture->next = (i + 1) % FRAME_CAPTURE_BUFFERS;
+    return true;
+}
+
+bool frame_capture_finish(FrameCapture* capture) {
+    // Oldest first, so files appear in frame order
+    bool ok = true;
+    for (int k = 0; k < FRAME_CAPTURE_BUFFERS; k++) {
+        if (!queue_buffer(capture, (capture->next + k) % FRAME_CAPTURE_BUFFERS)) ok = false;
+    }
+    stop_writer(capture);
+    return ok && !capture->failed;
+}
+
+void frame_capture_destroy(FrameCapture* capture) {
+    if (capture) {
+        stop_writer(capture);
+        for (int i = 0; i < FRAME_CAPTURE_BUFFERS; i++) {
+            if (capture->fences[i]) glDeleteSync(capture->fences[i]);
+        }
+        glDeleteBuffers(FRAME_CAPTURE_BUFFERS, capture->buffers);
+        free(capture->directory);
+        for (int i = 0; i < FRAME_CAPTURE_QUEUE; i++) free(capture->queue[i]);
+        free(capture->row);
+        pthread_mutex_destroy(&capture->mutex);
+        pthread_cond_destroy(&capture->frame_ready);
+        pthread_cond_destroy(&capture->slot_free);
+        free(capture);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <GL/gl.h>
+
+// Frames being read back at once: a frame is written out while the GPU
+// still renders and copies the next two
+#define FRAME_CAPTURE_BUFFERS 3
+
+// Frames copied out of the pack buffers and waiting for the writer thread
+#define FRAME_CAPTURE_QUEUE 3
+
+// Writes rendered frames to numbered image files (binary PPM,
+// frame_00000.ppm, ...) without stalling the GPU or the render loop.
+// glReadPixels goes into a ring of pixel pack buffers; a buffer is mapped
+// only when the ring comes back to it, by which time its copy has usually
+// finished. The mapped frame is copied into a queue, and a writer thread
+// converts it to RGB and writes the file while the next frames render.
+typedef struct {
+    GLuint buffers[FRAME_CAPTURE_BUFFERS];  // Pixel pack buffers, filled in turn
+    GLsync fences[FRAME_CAPTURE_BUFFERS];   // Readback into each buffer (NULL = empty)
+    int frames[FRAME_CAPTURE_BUFFERS];      // Frame number held by each buffer
+    int next;                               // Buffer the next frame goes to
+    int width;
+    int height;
+    char* directory;
+
+    // Queue shared with the writer thread (guarded by mutex)
+    unsigned char* queue[FRAME_CAPTURE_QUEUE];  // RGBA frames, bottom row first
+    int queue_frames[FRAME_CAPTURE_QUEUE];      // Frame number of each entry
+    int head;                               // Oldest queued entry
+    int queued;                             // Entries the writer hasn't finished
+    bool stop;                              // No more frames: writer exits when empty
+    bool failed;                            // A file couldn't be written
+    int written;                            // Frames written so far
+    pthread_mutex_t mutex;
+    pthread_cond_t frame_ready;
+    pthread_cond_t slot_free;
+    pthread_t writer;
+    bool writer_running;
+    unsigned char* row;                     // One RGB row of the file being written (writer only)
+} FrameCapture;
+
+// Capture width x height frames into `directory` (created if missing).
+// NULL if the directory or buffers can't be created.
+FrameCapture* frame_capture_create(int width, int height, const char* directory);
+
+// Start reading back the color buffer of `framebuffer` as frame number
+// `frame`. Hands the oldest frame to the writer first if the ring is full
+// (waiting if the writer is a whole queue behind); false once any write has
+// failed.
+bool frame_capture_push(FrameCapture* capture, GLuint framebuffer, int frame);
+
+// Write out all frames still in the ring and wait for the writer; false if
+// any write failed. No frames can be pushed afterwards.
+bool frame_capture_finish(FrameCapture* capture);
+
+void frame_capture_destroy(FrameCapture* capture);
+
+#endif // FRAME_CAPTURE_H
@@ -0,0 +1,305 @@
+#define GL_GLEXT_PROTOTYPES  // glDispatchCompute, glBeginTransformFeedback, ... from glext.h
+#include "gpu_particles.h"
+#include "renderer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <GL/gl.h>
+
+// Invocations per work group (local_size_x in shaders/particles.comp)
+#define GPU_PARTICLES_GROUP 256
+
+// Values of PASS
+#define PASS_STEP 0
+#define PASS_EMIT 1
+#define PASS_SPAWN 2
+
+// Bytes of one particle's records: the larger of the two layouts
+#define GPU_RECORD_SIZE (2 * sizeof(ParticleVertex))
+
+// Build the program of one pass. Field, integrator and record layout are
+// compile-time constants so an invocation runs only its own code: llvmpipe
+// executes every side of a branch on a uniform, which doubled the step's
+// cost.
+static ShaderProgram create_pass_program(const GpuParticles* gp, int pass, int field, int integrator, int mode) {
+    char prelude[160];
+    snprintf(prelude, sizeof(prelude),
+             "#version %s\n#define PASS %d\n#define FIELD %d\n#define INTEGRATOR %d\n#define MODE %d\n",
+             gp->feedback ? "330 core" : "430 core", pass, field, integrator, mode);
+
+    if (!gp->feedback) {
+        const char* sources[] = { "shaders/particles_common.glsl", "shaders/particles.comp", "shaders/fields.glsl" };
+        return shader_create_compute(prelude, sources, 3);
+    }
+
+    // Emits write one interleaved record per particle, steps and spawns a
+    // position and a state buffer
+    const char* sources[] = { "shaders/particles_common.glsl", "shaders/particles_feedback.vert", "shaders/fields.glsl" };
+    if (pass == PASS_EMIT) {
+        const char* varyings[] = { "tf_record" };
+        return shader_create_feedback(prelude, sources, 3, varyings, 1, true);
+    }
+    const char* varyings[] = { "tf_position", "tf_state" };
+    return shader_create_feedback(prelude, sources, 3, varyings, 2, false);
+}
+
+GpuParticles* gpu_particles_create(int count, unsigned int seed, bool feedback) {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major < 3 || (major == 3 && minor < 3)) {
+        fprintf(stderr, "Error: GPU simulation needs OpenGL 3.3 (context is %d.%d)\n", major, minor);
+        return NULL;
+    }
+    if (!feedback && (major < 4 || (major == 4 && minor < 3))) {
+        printf("No compute shaders in OpenGL %d.%d, simulating with transform feedback\n", major, minor);
+        feedback = true;
+    }
+
+    GpuParticles* gp = (GpuParticles*)calloc(1, sizeof(GpuParticles));
+    if (!gp) {
+        fprintf(stderr, "Error: Failed to allocate GPU particles\n");
+        return NULL;
+    }
+    gp->feedback = feedback;
+
+    // Step programs follow on first use
+    gp->spawn_program = create_pass_program(gp, PASS_SPAWN, -1, 0, 0);
+    gp->emit_programs[RENDER_LINES] = create_pass_program(gp, PASS_EMIT, -1, 0, RENDER_LINES);
+    gp->emit_programs[RENDER_QUADS] = create_pass_program(gp, PASS_EMIT, -1, 0, RENDER_QUADS);
+    if (!gp->spawn_program.is_valid || !gp->emit_programs[RENDER_LINES].is_valid ||
+        !gp->emit_programs[RENDER_QUADS].is_valid) {
+        fprintf(stderr, "Error: Failed to create particle simulation programs\n");
+        gpu_particles_destroy(gp);
+        return NULL;
+    }
+
+    gp->count = count < 1 ? 1 : (count > GPU_PARTICLES_MAX_COUNT ? GPU_PARTICLES_MAX_COUNT : count);
+    gp->mode = RENDER_LINES;
+
+    // Seed 0 picks one from the clock; print it so the run can be repeated
+    gp->seed = seed ? seed : (unsigned int)time(NULL);
+    gp->frame = 0;
+    printf("GPU particles: %d, %s (random seed: %u)\n", gp->count,
+           feedback ? "transform feedback" : "compute shaders", gp->seed);
+
+    // Written and read by the GPU only. Transform feedback can't read and
+    // write the same buffer, so its steps alternate between two pairs.
+    size_t n = (size_t)gp->count;
+    int pairs = feedback ? 2 : 1;
+    while (glGetError() != GL_NO_ERROR) {}
+    for (int i = 0; i < pairs; i++) {
+        glGenBuffers(1, &gp->positions[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, gp->positions[i]);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(n * 4 * sizeof(float)), NULL, GL_DYNAMIC_COPY);
+        glGenBuffers(1, &gp->states[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, gp->states[i]);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(n * 2 * sizeof(float)), NULL, GL_DYNAMIC_COPY);
+    }
+    glGenBuffers(1, &gp->records);
+    glBindBuffer(GL_ARRAY_BUFFER, gp->records);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(n * GPU_RECORD_SIZE), NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (feedback) glGenVertexArrays(1, &gp->vertex_array);
+
+    if (glGetError() == GL_OUT_OF_MEMORY) {
+        fprintf(stderr, "Error: Failed to allocate GPU particle buffers\n");
+        gpu_particles_destroy(gp);
+        return NULL;
+    }
+
+    return gp;
+}
+
+// Step program for the configured field and integrator, NULL if it
+// doesn't compile
+static const ShaderProgram* step_program(GpuParticles* gp, const Config* config) {
+    int field = config->vector_field_num;
+    if (field < 0 || field >= GPU_FIELD_COUNT) field = GPU_FIELD_COUNT;  // Stands still
+    int integrator = config->integrator == INTEGRATOR_EULER ? 0
+                   : (config->integrator == INTEGRATOR_MIDPOINT ? 1 : 2);
+
+    ShaderProgram* program = &gp->step_programs[field][integrator];
+    if (!program->is_valid && !gp->step_failed[field][integrator]) {
+        *program = create_pass_program(gp, PASS_STEP, field, integrator, 0);
+        gp->step_failed[field][integrator] = !program->is_valid;
+    }
+    return program->is_valid ? program : NULL;
+}
+
+// Use a pass's program and set the uniforms every pass shares; uniforms of
+// the pass follow
+static void begin_pass(const GpuParticles* gp, const ShaderProgram* program, const Camera* cam) {
+    float left, right, bottom, top;
+    camera_get_view_bounds(cam, &left, &right, &bottom, &top);
+
+    shader_use(program);
+    shader_set_int(program, "u_count", gp->count);
+    shader_set_uint(program, "u_seed", gp->seed);
+    shader_set_uint(program, "u_frame", gp->frame);
+    shader_set_vec4(program, "u_view", left, right, bottom, top);
+    shader_set_vec2(program, "u_margin", (right - left) * 0.15f, (top - bottom) * 0.15f);
+}
+
+// Compute: run the pass over all particles; `barrier` orders its writes
+// before their next use
+static void dispatch(const GpuParticles* gp, GLbitfield barrier) {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, gp->positions[0]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, gp->states[0]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, gp->records);
+    glDispatchCompute((GLuint)((gp->count + GPU_PARTICLES_GROUP - 1) / GPU_PARTICLES_GROUP), 1, 1);
+    glMemoryBarrier(barrier);
+    glUseProgram(0);
+}
+
+// Transform feedback: draw one point per particle, reading the current
+// state if `read_state`, and capture into `output` (and `output2`)
+static void draw_feedback(const GpuParticles* gp, bool read_state, unsigned int output, unsigned int output2) {
+    glBindVertexArray(gp->vertex_array);
+    if (read_state) {
+        glBindBuffer(GL_ARRAY_BUFFER, gp->positions[gp->current]);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, gp->states[gp->current]);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    } else {
+        glDisableVertexAttribArray(0);
+        glDisableVertexAttribArray(1);
+    }
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, output);
+    if (output2) glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, output2);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, gp->count);
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    if (output2) glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, 0);
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
+void gpu_particles_redistribute(GpuParticles* gp, const Config* config, const Camera* cam, bool grid) {
+    if (!gp) return;
+    const ShaderProgram* program = &gp->spawn_program;
+    begin_pass(gp, program, cam);
+    shader_set_int(program, "u_grid_size", grid ? (int)sqrtf((float)gp->count) : 0);
+    shader_set_float(program, "u_lifetime_mult", config->particle_lifetime * (grid ? 0.3f : 0.5f));
+    if (gp->feedback) {
+        draw_feedback(gp, false, gp->positions[gp->current], gp->states[gp->current]);
+    } else {
+        dispatch(gp, GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+}
+
+void gpu_particles_update(GpuParticles* gp, const Config* config, const Camera* cam, float dt) {
+    if (!gp || config->paused) return;
+    const ShaderProgram* program = step_program(gp, config);
+    if (!program) return;
+
+    // Same step as the CPU update (see particle_system_update_emit)
+    float adaptive_step = config->integration_step / cam->zoom;
+    begin_pass(gp, program, cam);
+    shader_set_float(program, "u_scale", config->field_scale);
+    shader_set_float(program, "u_dt", dt * config->simulation_speed * adaptive_step);
+    shader_set_float(program, "u_lifetime", config->particle_lifetime);
+    if (gp->feedback) {
+        int next = 1 - gp->current;
+        draw_feedback(gp, true, gp->positions[next], gp->states[next]);
+        gp->current = next;
+    } else {
+        dispatch(gp, GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    gp->frame++;
+}
+
+void gpu_particles_emit(GpuParticles* gp, const Config* config, const Camera* cam, float alpha) {
+    if (!gp) return;
+    gp->mode = config->render_mode == RENDER_QUADS ? RENDER_QUADS : RENDER_LINES;
+    const ShaderProgram* program = &gp->emit_programs[gp->mode];
+    begin_pass(gp, program, cam);
+    shader_set_float(program, "u_interpolate", alpha);
+    shader_set_float(program, "u_alpha", PARTICLE_ALPHA);
+    if (gp->feedback) {
+        draw_feedback(gp, true, gp->records, 0);
+    } else {
+        dispatch(gp, GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    }
+}
+
+void gpu_particles_upload(GpuParticles* gp, const ParticleSystem* ps) {
+    if (!gp || !ps) return;
+    int n = ps->count < gp->count ? ps->count : gp->count;
+    float* positions = (float*)malloc(sizeof(float) * 4 * (size_t)n);
+    float* states = (float*)malloc(sizeof(float) * 2 * (size_t)n);
+    if (positions && states) {
+        for (int i = 0; i < n; i++) {
+            positions[4 * i] = ps->x[i];
+            positions[4 * i + 1] = ps->y[i];
+            positions[4 * i + 2] = ps->prev_x[i];
+            positions[4 * i + 3] = ps->prev_y[i];
+            states[2 * i] = ps->lifetime[i];
+            states[2 * i + 1] = ps->speed[i];
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, gp->positions[gp->current]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(sizeof(float) * 4 * (size_t)n), positions);
+        glBindBuffer(GL_ARRAY_BUFFER, gp->states[gp->current]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(sizeof(float) * 2 * (size_t)n), states);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    } else {
+        fprintf(stderr, "Error: Failed to allocate GPU particle upload\n");
+    }
+    free(positions);
+    free(states);
+}
+
+void gpu_particles_download(const GpuParticles* gp, ParticleSystem* ps) {
+    if (!gp || !ps) return;
+    int n = ps->count < gp->count ? ps->count : gp->count;
+    float* positions = (float*)malloc(sizeof(float) * 4 * (size_t)n);
+    float* states = (float*)malloc(sizeof(float) * 2 * (size_t)n);
+    if (positions && states) {
+        if (!gp->feedback) glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_ARRAY_BUFFER, gp->positions[gp->current]);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(sizeof(float) * 4 * (size_t)n), positions);
+        glBindBuffer(GL_ARRAY_BUFFER, gp->states[gp->current]);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(sizeof(float) * 2 * (size_t)n), states);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        for (int i = 0; i < n; i++) {
+            ps->x[i] = positions[4 * i];
+            ps->y[i] = positions[4 * i + 1];
+            ps->prev_x[i] = positions[4 * i + 2];
+            ps->prev_y[i] = positions[4 * i + 3];
+            ps->lifetime[i] = states[2 * i];
+            ps->speed[i] = states[2 * i + 1];
+        }
+    } else {
+        fprintf(stderr, "Error: Failed to allocate GPU particle download\n");
+    }
+    free(positions);
+    free(states);
+}
+
+void gpu_particles_destroy(GpuParticles* gp) {
+    if (gp) {
+        glDeleteBuffers(2, gp->positions);
+        glDeleteBuffers(2, gp->states);
+        glDeleteBuffers(1, &gp->records);
+        glDeleteVertexArrays(1, &gp->vertex_array);
+        shader_delete(&gp->spawn_program);
+        shader_delete(&gp->emit_programs[RENDER_LINES]);
+        shader_delete(&gp->emit_programs[RENDER_QUADS]);
+        for (int f = 0; f <= GPU_FIELD_COUNT; f++) {
+            for (int i = 0; i < GPU_INTEGRATOR_COUNT; i++) {
+                shader_delete(&gp->step_programs[f][i]);
+            }
+        }
+        free(gp);
+    }
+}
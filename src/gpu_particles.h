@@ -0,0 +1,76 @@
+#ifndef GPU_PARTICLES_H
+#define GPU_PARTICLES_H
+
+#include "config.h"
+#include "camera.h"
+#include "particles.h"
+#include "shader.h"
+
+#include <stdbool.h>
+
+// Most particles of one dispatch (65535 work groups of 256)
+#define GPU_PARTICLES_MAX_COUNT (65535 * 256)
+
+// Fields ported to shaders/fields.glsl; others stand still
+#define GPU_FIELD_COUNT 9
+
+// Euler, midpoint and RK4 (RK45 runs as RK4)
+#define GPU_INTEGRATOR_COUNT 3
+
+// Particle simulation on the GPU (simulation_backend = gpu or feedback).
+// Positions and states live in GPU buffers and never leave it: steps
+// integrate and respawn in place, and each frame's vertex records (the
+// renderer's ParticleVertex or ParticleInstance layout) are written into
+// `records` for renderer_attach_particles. GL 4.3 contexts run compute
+// shaders over storage buffers; GL 3.3 contexts draw one point per
+// particle with transform feedback, each step writing the other pair of
+// state buffers.
+//
+// Compared to ParticleSystem: fixed-step integrators only (RK45 runs as
+// RK4), exact GLSL field evaluation (no field cache, flow map, multirate or
+// math_precision), respawns uniform over the view (no density control),
+// and no spatial sort. The count doesn't follow the zoom.
+typedef struct {
+    bool feedback;             // Transform feedback instead of compute shaders
+    unsigned int positions[2]; // (x, y, prev_x, prev_y) per particle
+    unsigned int states[2];    // (lifetime, speed) per particle
+    int current;               // Pair holding the current state (compute: always 0)
+    unsigned int records;      // Vertex records of the current frame
+    unsigned int vertex_array; // Feedback: attributes of the state being read
+    int count;
+    RenderMode mode;           // Layout in `records`
+    unsigned int seed;         // RNG key, as ParticleSystem.seed
+    unsigned int frame;        // Step counter, part of the RNG counter
+
+    // One program per pass (see shaders/particles_common.glsl), the steps
+    // per field and integrator, compiled on first use
+    ShaderProgram spawn_program;
+    ShaderProgram emit_programs[2];  // Per RenderMode
+    ShaderProgram step_programs[GPU_FIELD_COUNT + 1][GPU_INTEGRATOR_COUNT];
+    bool step_failed[GPU_FIELD_COUNT + 1][GPU_INTEGRATOR_COUNT];  // Don't retry a failed compile
+} GpuParticles;
+
+// Compute shaders where the context has them (GL 4.3), transform feedback
+// otherwise or when `feedback` is set. NULL below GL 3.3 or if the buffers
+// or programs can't be created. A zero seed is taken from the clock.
+GpuParticles* gpu_particles_create(int count, unsigned int seed, bool feedback);
+
+// Redistribute like particle_system_redistribute_grid (grid) or
+// particle_system_redistribute, with the same random numbers
+void gpu_particles_redistribute(GpuParticles* gp, const Config* config, const Camera* cam, bool grid);
+
+// One simulation step of dt seconds (no-op while paused)
+void gpu_particles_update(GpuParticles* gp, const Config* config, const Camera* cam, float dt);
+
+// Write the frame's records at render time alpha between the last two steps
+void gpu_particles_emit(GpuParticles* gp, const Config* config, const Camera* cam, float alpha);
+
+// Copy state between the GPU and a ParticleSystem of at least gp->count
+// particles (positions, lifetimes and speeds; debugging and the cross-check
+// of tools/gpu_check.c)
+void gpu_particles_upload(GpuParticles* gp, const ParticleSystem* ps);
+void gpu_particles_download(const GpuParticles* gp, ParticleSystem* ps);
+
+void gpu_particles_destroy(GpuParticles* gp);
+
+#endif // GPU_PARTICLES_H
@@ -0,0 +1,120 @@
+#define GL_GLEXT_PROTOTYPES  // glGenFramebuffers, ... from glext.h
+#include "headless.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+
+// Display on the surfaceless platform, EGL_NO_DISPLAY if it's missing
+static EGLDisplay surfaceless_display(void) {
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "EGL_MESA_platform_surfaceless")) return EGL_NO_DISPLAY;
+
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (!get_platform_display) return EGL_NO_DISPLAY;
+    return get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+}
+
+// Pick a config, create a core profile context (the driver's newest
+// version compatible with 3.3) and make it current; false if any step fails
+static bool headless_init_context(HeadlessContext* headless, bool surfaceless) {
+    if (!eglInitialize(headless->display, NULL, NULL)) return false;
+    if (!eglBindAPI(EGL_OPENGL_API)) return false;
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = NULL;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(headless->display, config_attributes, &config, 1, &config_count)) return false;
+    if (config_count == 0 && !surfaceless) return false;
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    headless->context = eglCreateContext(headless->display, config_count ? config : (EGLConfig)0,
+                                         EGL_NO_CONTEXT, context_attributes);
+    if (headless->context == EGL_NO_CONTEXT) return false;
+
+    if (!surfaceless) {
+        const EGLint pbuffer_attributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        headless->surface = eglCreatePbufferSurface(headless->display, config, pbuffer_attributes);
+        if (headless->surface == EGL_NO_SURFACE) return false;
+    }
+    return eglMakeCurrent(headless->display, headless->surface, headless->surface, headless->context);
+}
+
+// Release whatever EGL objects exist so another display can be tried
+static void headless_release_egl(HeadlessContext* headless) {
+    if (headless->context != EGL_NO_CONTEXT) {
+        eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(headless->display, headless->context);
+    }
+    if (headless->surface != EGL_NO_SURFACE) eglDestroySurface(headless->display, headless->surface);
+    if (headless->display != EGL_NO_DISPLAY) eglTerminate(headless->display);
+    headless->display = EGL_NO_DISPLAY;
+    headless->context = EGL_NO_CONTEXT;
+    headless->surface = EGL_NO_SURFACE;
+}
+
+HeadlessContext* headless_create(int width, int height) {
+    HeadlessContext* headless = (HeadlessContext*)calloc(1, sizeof(HeadlessContext));
+    if (!headless) {
+        fprintf(stderr, "Error: Failed to allocate headless context\n");
+        return NULL;
+    }
+    headless->display = EGL_NO_DISPLAY;
+    headless->context = EGL_NO_CONTEXT;
+    headless->surface = EGL_NO_SURFACE;
+    headless->width = width;
+    headless->height = height;
+
+    // Surfaceless first; a pbuffer on the default display otherwise
+    bool surfaceless = true;
+    headless->display = surfaceless_display();
+    if (headless->display == EGL_NO_DISPLAY || !headless_init_context(headless, true)) {
+        headless_release_egl(headless);
+        surfaceless = false;
+        headless->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (headless->display == EGL_NO_DISPLAY || !headless_init_context(headless, false)) {
+            fprintf(stderr, "Error: No EGL display with desktop OpenGL (EGL error 0x%x)\n", eglGetError());
+            headless_destroy(headless);
+            return NULL;
+        }
+    }
+
+    glGenFramebuffers(1, &headless->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless->framebuffer);
+    glGenRenderbuffers(1, &headless->color);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless->color);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Error: Headless framebuffer incomplete\n");
+        headless_destroy(headless);
+        return NULL;
+    }
+
+    printf("Headless: %s, OpenGL %s (%s)\n", surfaceless ? "EGL surfaceless" : "EGL pbuffer",
+           (const char*)glGetString(GL_VERSION), (const char*)glGetString(GL_RENDERER));
+    return headless;
+}
+
+void headless_destroy(HeadlessContext* headless) {
+    if (headless) {
+        if (headless->context != EGL_NO_CONTEXT) {
+            glDeleteFramebuffers(1, &headless->framebuffer);
+            glDeleteRenderbuffers(1, &headless->color);
+        }
+        headless_release_egl(headless);
+        free(headless);
+    }
+}
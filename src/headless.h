@@ -0,0 +1,28 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <stdbool.h>
+#include <EGL/egl.h>
+
+// OpenGL without a window system (--headless): an EGL context on Mesa's
+// surfaceless platform, or on the default display with a 1x1 pbuffer where
+// that platform is missing. Frames go to an off-screen framebuffer of the
+// window's size, left bound as the draw target so the Renderer presents
+// into it like into a window.
+typedef struct {
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;        // EGL_NO_SURFACE on the surfaceless platform
+    unsigned int framebuffer;
+    unsigned int color;        // RGBA8 renderbuffer
+    int width;
+    int height;
+} HeadlessContext;
+
+// Create the context, make it current and bind the framebuffer. NULL if no
+// EGL display offers desktop OpenGL.
+HeadlessContext* headless_create(int width, int height);
+
+void headless_destroy(HeadlessContext* headless);
+
+#endif // HEADLESS_H
@@ -0,0 +1,358 @@
+#include "integrator.h"
+#include "simd.h"
+
+#include <math.h>
+#include <string.h>
+
+#define B INTEGRATOR_MAX_BATCH
+
+// First stage of every integrator: k1 and the color speed
+static void evaluate_first_stage(const VectorFieldEvaluator* field, const float* x, const float* y,
+                                 float* k1x, float* k1y, float* speed, int n) {
+    vector_field_evaluate_batch(field, x, y, k1x, k1y, n);
+    for (int i = 0; i < n; i++) {
+        speed[i] = particle_speed(k1x[i], k1y[i]);
+    }
+}
+
+// =============================================================================
+// Fixed-Step Integrators
+// =============================================================================
+
+static void integrate_euler(const VectorFieldEvaluator* field, float* restrict x, float* restrict y,
+                            float* restrict speed, int n, float dt) {
+    float k1x[B], k1y[B];
+
+    evaluate_first_stage(field, x, y, k1x, k1y, speed, n);
+    for (int i = 0; i < n; i++) {
+        x[i] += k1x[i] * dt;
+        y[i] += k1y[i] * dt;
+    }
+}
+
+static void integrate_midpoint(const VectorFieldEvaluator* field, float* restrict x, float* restrict y,
+                               float* restrict speed, int n, float dt) {
+    float k1x[B], k1y[B];
+    float k2x[B], k2y[B];
+    float sx[B], sy[B];
+
+    float dt_half = dt * 0.5f;
+
+    evaluate_first_stage(field, x, y, k1x, k1y, speed, n);
+    for (int i = 0; i < n; i++) {
+        sx[i] = x[i] + k1x[i] * dt_half;
+        sy[i] = y[i] + k1y[i] * dt_half;
+    }
+
+    vector_field_evaluate_batch(field, sx, sy, k2x, k2y, n);
+    for (int i = 0; i < n; i++) {
+        x[i] += k2x[i] * dt;
+        y[i] += k2y[i] * dt;
+    }
+}
+
+static void integrate_rk4(const VectorFieldEvaluator* field, float* restrict x, float* restrict y,
+                          float* restrict speed, int n, float dt) {
+    float k1x[B], k1y[B];
+    float k2x[B], k2y[B];
+    float k3x[B], k3y[B];
+    float k4x[B], k4y[B];
+    float sx[B], sy[B];
+
+    float dt_half = dt * 0.5f;
+    float dt_sixth = dt * 0.16666667f;
+
+    evaluate_first_stage(field, x, y, k1x, k1y, speed, n);
+    for (int i = 0; i < n; i++) {
+        sx[i] = x[i] + k1x[i] * dt_half;
+        sy[i] = y[i] + k1y[i] * dt_half;
+    }
+
+    vector_field_evaluate_batch(field, sx, sy, k2x, k2y, n);
+    for (int i = 0; i < n; i++) {
+        sx[i] = x[i] + k2x[i] * dt_half;
+        sy[i] = y[i] + k2y[i] * dt_half;
+    }
+
+    vector_field_evaluate_batch(field, sx, sy, k3x, k3y, n);
+    for (int i = 0; i < n; i++) {
+        sx[i] = x[i] + k3x[i] * dt;
+        sy[i] = y[i] + k3y[i] * dt;
+    }
+
+    vector_field_evaluate_batch(field, sx, sy, k4x, k4y, n);
+    for (int i = 0; i < n; i++) {
+        x[i] += (k1x[i] + 2.0f*k2x[i] + 2.0f*k3x[i] + k4x[i]) * dt_sixth;
+        y[i] += (k1y[i] + 2.0f*k2y[i] + 2.0f*k3y[i] + k4y[i]) * dt_sixth;
+    }
+}
+
+// =============================================================================
+// Dormand-Prince RK45
+// =============================================================================
+
+// Butcher tableau (Dormand & Prince 1980). The 5th-order weights equal the
+// last row, so the final stage is k1 of the next step (FSAL).
+#define A21 (1.0f/5.0f)
+#define A31 (3.0f/40.0f)
+#define A32 (9.0f/40.0f)
+#define A41 (44.0f/45.0f)
+#define A42 (-56.0f/15.0f)
+#define A43 (32.0f/9.0f)
+#define A51 (19372.0f/6561.0f)
+#define A52 (-25360.0f/2187.0f)
+#define A53 (64448.0f/6561.0f)
+#define A54 (-212.0f/729.0f)
+#define A61 (9017.0f/3168.0f)
+#define A62 (-355.0f/33.0f)
+#define A63 (46732.0f/5247.0f)
+#define A64 (49.0f/176.0f)
+#define A65 (-5103.0f/18656.0f)
+#define A71 (35.0f/384.0f)
+#define A73 (500.0f/1113.0f)
+#define A74 (125.0f/192.0f)
+#define A75 (-2187.0f/6784.0f)
+#define A76 (11.0f/84.0f)
+
+// Error weights: 5th-order minus embedded 4th-order solution
+#define E1 (71.0f/57600.0f)
+#define E3 (-71.0f/16695.0f)
+#define E4 (71.0f/1920.0f)
+#define E5 (-17253.0f/339200.0f)
+#define E6 (22.0f/525.0f)
+#define E7 (-1.0f/40.0f)
+
+// Stage loops and field batches run over counts rounded up to this. The
+// fixed-length inner loop lets GCC vectorize at -O2 without a scalar
+// epilogue; padding lanes carry stale state and are never written back.
+#define RK45_PAD 8
+#define FOR_PADDED(j, m) \
+    for (int j##_base = 0; j##_base < (m); j##_base += RK45_PAD) \
+        for (int j = j##_base; j < j##_base + RK45_PAD; j++)
+
+#if RK45_PAD % SIMD_WIDTH != 0
+#error "RK45_PAD must be a multiple of SIMD_WIDTH"
+#endif
+
+// x^(-1/5) to ~2% (plenty for a step size controller): exponent-bit
+// estimate refined by one Newton step on y^5 * x = 1
+static inline vf rk45_pow_neg_fifth(vf x) {
+    vi one = vi_set1(0x3F800000);
+    vf log_est = vi_to_vf(vi_sub(vf_as_vi(x), one));
+    vf y = vi_as_vf(vi_sub(one, vf_round_vi(vf_mul(log_est, vf_set1(0.2f)))));
+    vf y2 = vf_mul(y, y);
+    vf y5 = vf_mul(vf_mul(y2, y2), y);
+    return vf_mul(vf_mul(y, vf_fmadd(vf_sub(vf_set1(0.0f), x), y5, vf_set1(6.0f))), vf_set1(0.2f));
+}
+
+// Step size controller: h *= clamp(SAFETY * err^(-1/5), MIN, MAX)
+#define RK45_SAFETY      0.9f
+#define RK45_MIN_FACTOR  0.2f
+#define RK45_MAX_FACTOR  5.0f
+
+// Each pass takes one step for every particle that still has time left in
+// the frame. Unfinished particles are kept compacted at the front of the
+// work arrays, so every field batch covers only live particles.
+static void integrate_rk45(const IntegratorParams* params, const VectorFieldEvaluator* field,
+                           float* restrict x, float* restrict y, float* restrict speed,
+                           float* restrict step, int n) {
+    // Compacted per-particle state
+    int idx[B];
+    float cx[B], cy[B];       // Position
+    float ch[B];              // Step size of the next attempt
+    float ct[B];              // Time left in this frame
+    float k1x[B], k1y[B];     // Derivative at the position (FSAL)
+
+    // Stages 2..7
+    float k2x[B], k2y[B], k3x[B], k3y[B], k4x[B], k4y[B];
+    float k5x[B], k5y[B], k6x[B], k6y[B], k7x[B], k7y[B];
+    float sx[B], sy[B];
+    float err[B], factor[B];  // Scaled error, step size factor
+
+    float dt = params->dt;
+
+    evaluate_first_stage(field, x, y, k1x, k1y, speed, n);
+    for (int i = 0; i < n; i++) {
+        idx[i] = i;
+        cx[i] = x[i];
+        cy[i] = y[i];
+        ct[i] = dt;
+        ch[i] = (step[i] > 0.0f && step[i] < dt) ? step[i] : dt;
+    }
+    for (int i = n; i < B; i++) {
+        cx[i] = cy[i] = ch[i] = ct[i] = 0.0f;
+        k1x[i] = k1y[i] = 0.0f;
+    }
+
+    int m = n;
+    for (int pass = 0; pass < params->max_steps && m > 0; pass++) {
+        // Out of budget: finish the frame in one step, whatever the error
+        bool last_pass = pass == params->max_steps - 1;
+        if (last_pass) {
+            memcpy(ch, ct, sizeof(float) * m);
+        }
+
+        int mp = (m + RK45_PAD - 1) & ~(RK45_PAD - 1);
+
+        FOR_PADDED(j, m) {
+            float h = ch[j];
+            sx[j] = cx[j] + h * (A21 * k1x[j]);
+            sy[j] = cy[j] + h * (A21 * k1y[j]);
+        }
+        vector_field_evaluate_batch(field, sx, sy, k2x, k2y, mp);
+
+        FOR_PADDED(j, m) {
+            float h = ch[j];
+            sx[j] = cx[j] + h * (A31 * k1x[j] + A32 * k2x[j]);
+            sy[j] = cy[j] + h * (A31 * k1y[j] + A32 * k2y[j]);
+        }
+        vector_field_evaluate_batch(field, sx, sy, k3x, k3y, mp);
+
+        FOR_PADDED(j, m) {
+            float h = ch[j];
+            sx[j] = cx[j] + h * (A41 * k1x[j] + A42 * k2x[j] + A43 * k3x[j]);
+            sy[j] = cy[j] + h * (A41 * k1y[j] + A42 * k2y[j] + A43 * k3y[j]);
+        }
+        vector_field_evaluate_batch(field, sx, sy, k4x, k4y, mp);
+
+        FOR_PADDED(j, m) {
+            float h = ch[j];
+            sx[j] = cx[j] + h * (A51 * k1x[j] + A52 * k2x[j] + A53 * k3x[j] + A54 * k4x[j]);
+            sy[j] = cy[j] + h * (A51 * k1y[j] + A52 * k2y[j] + A53 * k3y[j] + A54 * k4y[j]);
+        }
+        vector_field_evaluate_batch(field, sx, sy, k5x, k5y, mp);
+
+        FOR_PADDED(j, m) {
+            float h = ch[j];
+            sx[j] = cx[j] + h * (A61 * k1x[j] + A62 * k2x[j] + A63 * k3x[j] + A64 * k4x[j] + A65 * k5x[j]);
+            sy[j] = cy[j] + h * (A61 * k1y[j] + A62 * k2y[j] + A63 * k3y[j] + A64 * k4y[j] + A65 * k5y[j]);
+        }
+        vector_field_evaluate_batch(field, sx, sy, k6x, k6y, mp);
+
+        // 5th-order solution; the last stage is evaluated there
+        FOR_PADDED(j, m) {
+            float h = ch[j];
+            sx[j] = cx[j] + h * (A71 * k1x[j] + A73 * k3x[j] + A74 * k4x[j] + A75 * k5x[j] + A76 * k6x[j]);
+            sy[j] = cy[j] + h * (A71 * k1y[j] + A73 * k3y[j] + A74 * k4y[j] + A75 * k5y[j] + A76 * k6y[j]);
+        }
+        vector_field_evaluate_batch(field, sx, sy, k7x, k7y, mp);
+
+        // Scaled error norm and step size factor per particle. Non-finite
+        // errors (near singularities) are rejected with the smallest factor.
+        vf inv_tolerance = vf_set1(1.0f / params->tolerance);
+        for (int j = 0; j < mp; j += SIMD_WIDTH) {
+            vf ex = vf_mul(vf_set1(E1), vf_load(k1x + j));
+            vf ey = vf_mul(vf_set1(E1), vf_load(k1y + j));
+            ex = vf_fmadd(vf_set1(E3), vf_load(k3x + j), ex);
+            ey = vf_fmadd(vf_set1(E3), vf_load(k3y + j), ey);
+            ex = vf_fmadd(vf_set1(E4), vf_load(k4x + j), ex);
+            ey = vf_fmadd(vf_set1(E4), vf_load(k4y + j), ey);
+            ex = vf_fmadd(vf_set1(E5), vf_load(k5x + j), ex);
+            ey = vf_fmadd(vf_set1(E5), vf_load(k5y + j), ey);
+            ex = vf_fmadd(vf_set1(E6), vf_load(k6x + j), ex);
+            ey = vf_fmadd(vf_set1(E6), vf_load(k6y + j), ey);
+            ex = vf_fmadd(vf_set1(E7), vf_load(k7x + j), ex);
+            ey = vf_fmadd(vf_set1(E7), vf_load(k7y + j), ey);
+
+            vf h = vf_load(ch + j);
+            ex = vf_abs(vf_mul(h, ex));
+            ey = vf_abs(vf_mul(h, ey));
+
+            // The sum is NaN or inf if either component is
+            vmask finite = vf_lt(vf_add(ex, ey), vf_set1(INFINITY));
+            vf e = vf_select(finite, vf_mul(vf_max(ex, ey), inv_tolerance), vf_set1(INFINITY));
+
+            vf f = vf_mul(vf_set1(RK45_SAFETY), rk45_pow_neg_fifth(vf_max(e, vf_set1(1e-10f))));
+            f = vf_min(vf_max(f, vf_set1(RK45_MIN_FACTOR)), vf_set1(RK45_MAX_FACTOR));
+            vf_store(err + j, e);
+            vf_store(factor + j, vf_select(finite, f, vf_set1(RK45_MIN_FACTOR)));
+        }
+
+        // Accept or reject, then compact the particles that still have time left
+        int live = 0;
+        for (int j = 0; j < m; j++) {
+            float h = ch[j];
+            bool accept = err[j] <= 1.0f || last_pass;
+            float t_left = ct[j];
+            if (accept) {
+                cx[j] = sx[j];
+                cy[j] = sy[j];
+                k1x[j] = k7x[j];
+                k1y[j] = k7y[j];
+                t_left -= h;
+            }
+
+            float h_next = h * factor[j];
+            int i = idx[j];
+
+            // Done for this frame: remember the step size for the next one
+            if (t_left <= dt * 1e-4f || last_pass) {
+                x[i] = cx[j];
+                y[i] = cy[j];
+                step[i] = h_next;
+                continue;
+            }
+
+            idx[live] = i;
+            cx[live] = cx[j];
+            cy[live] = cy[j];
+            k1x[live] = k1x[j];
+            k1y[live] = k1y[j];
+            ct[live] = t_left;
+            ch[live] = h_next < t_left ? h_next : t_left;
+            live++;
+        }
+        m = live;
+    }
+}
+
+// =============================================================================
+// Dispatch
+// =============================================================================
+
+// Generated from src/fields at build time (see Makefile): every fused loop by
+// field index, integrator, precision tier and ISA
+extern const IntegratorFusedFunc integrator_fused_table[][INTEGRATOR_COUNT][MATH_PRECISION_COUNT][SIMD_ISA_COUNT];
+extern const int integrator_fused_table_size;
+
+IntegratorFusedFunc integrator_resolve_fused(const Config* config) {
+    int field = config->vector_field_num;
+    if (field < 0 || field >= integrator_fused_table_size ||
+        config->integrator < 0 || config->integrator >= INTEGRATOR_COUNT) {
+        return NULL;
+    }
+
+    // Fused loops call the exact kernel; cached lookups need the generic path
+    if (config->field_cache != FIELD_CACHE_OFF) return NULL;
+
+    for (int isa = vector_field_detect_simd(); isa >= SIMD_ISA_NONE; isa--) {
+        IntegratorFusedFunc fused = integrator_fused_table[field][config->integrator][config->math_precision][isa];
+        if (fused) return fused;
+    }
+    return NULL;
+}
+
+void integrator_advance_batch(const IntegratorParams* params, const VectorFieldEvaluator* field,
+                              float* restrict x, float* restrict y, float* restrict speed,
+                              float* restrict step, int n) {
+    if (params->fused) {
+        params->fused(x, y, speed, n, params->dt, field->scale);
+        return;
+    }
+
+    switch (params->type) {
+        case INTEGRATOR_EULER:
+            integrate_euler(field, x, y, speed, n, params->dt);
+            break;
+        case INTEGRATOR_MIDPOINT:
+            integrate_midpoint(field, x, y, speed, n, params->dt);
+            break;
+        case INTEGRATOR_RK45:
+            integrate_rk45(params, field, x, y, speed, step, n);
+            break;
+        case INTEGRATOR_RK4:
+        default:
+            integrate_rk4(field, x, y, speed, n, params->dt);
+            break;
+    }
+}
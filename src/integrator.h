@@ -0,0 +1,52 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "config.h"
+#include "vector_field.h"
+
+#include <math.h>
+
+// Largest batch accepted by integrator_advance_batch (stage buffers live on
+// the stack)
+#define INTEGRATOR_MAX_BATCH 256
+
+// Specialized update loop for one (integrator, field) pair: advances
+// (x[i], y[i]) by dt and writes speed[i], for i in [0, n)
+typedef void (*IntegratorFusedFunc)(float* restrict x, float* restrict y, float* restrict speed,
+                                    int n, float dt, float scale);
+
+#define INTEGRATOR_FUSED_IMPL(name) \
+    void name(float* restrict x, float* restrict y, float* restrict speed, int n, float dt, float scale)
+
+// Normalized speed used for coloring
+static inline float particle_speed(float vx, float vy) {
+    // Use squared speed to avoid sqrt
+    float speed_sq = vx * vx + vy * vy;
+
+    // Normalize against squared threshold (2.0^2 = 4.0)
+    return fminf(speed_sq * 0.25f, 1.0f);  // *0.25 = /4.0
+}
+
+// Per-frame integration settings, derived from Config and the camera
+typedef struct {
+    IntegratorType type;
+    float dt;          // Time advanced per frame
+    float tolerance;   // RK45: allowed local error per step (world units)
+    int max_steps;     // RK45: per-particle step budget per frame
+    IntegratorFusedFunc fused;  // Specialized loop for the field (NULL = generic path)
+} IntegratorParams;
+
+// Specialized loop for the configured integrator, field and precision on the
+// widest ISA the CPU supports, or NULL when none was generated (RK45, or a
+// field without a SIMD kernel) or the field cache is on. Resolve once per frame.
+IntegratorFusedFunc integrator_resolve_fused(const Config* config);
+
+// Advance n <= INTEGRATOR_MAX_BATCH particles by params->dt.
+// speed[i] gets the normalized speed at the start position (drives color).
+// step[i] is the particle's RK45 step size carried across frames
+// (0 = start from dt); other integrators leave it untouched.
+void integrator_advance_batch(const IntegratorParams* params, const VectorFieldEvaluator* field,
+                              float* restrict x, float* restrict y, float* restrict speed,
+                              float* restrict step, int n);
+
+#endif // INTEGRATOR_H
@@ -15,30 +15,96 @@
 #include "particles.h"
 #include "vector_field.h"
 #include "renderer.h"
+#include "soft_renderer.h"
+#include "gpu_particles.h"
+#include "headless.h"
+#include "frame_capture.h"
 #include "camera.h"
+#include "thread_pool.h"
+#include "sim_clock.h"
 
 #include <stdio.h>
-#include <time.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
-// Calculate delta time
-float get_delta_time() {
-    static clock_t last_time = 0;
-    clock_t current_time = clock();
-    
-    if (last_time == 0) {
-        last_time = current_time;
-        return 0.016f; // Default to ~60 FPS
+// Frames of a --headless run without --frames
+#define HEADLESS_DEFAULT_FRAMES 600
+
+// --render defaults
+#define RENDER_DEFAULT_FPS 60.0f
+#define RENDER_DEFAULT_OUT "frames"
+
+// Command-line options
+typedef struct {
+    bool headless;   // EGL off-screen context instead of a window
+    int frames;      // Stop after this many frames (0 = until the window closes)
+    bool render;     // Offline: fixed 1/fps per frame, every frame written to `out`
+    float fps;
+    const char* out;
+} Options;
+
+// False (after printing the usage) on an unknown or incomplete option
+static bool parse_options(int argc, char** argv, Options* options) {
+    options->headless = false;
+    options->frames = 0;
+    options->render = false;
+    options->fps = RENDER_DEFAULT_FPS;
+    options->out = RENDER_DEFAULT_OUT;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            options->headless = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options->frames = atoi(argv[++i]);
+            if (options->frames < 0) options->frames = 0;
+        } else if (strcmp(argv[i], "--render") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            options->render = true;
+            options->frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc && atof(argv[i + 1]) > 0.0) {
+            options->fps = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            options->out = argv[++i];
+        } else {
+            printf("Usage: %s [--headless] [--frames N] [--render N [--fps F] [--out DIR]]\n", argv[0]);
+            return false;
+        }
+    }
+    if (options->render) options->headless = true;
+    if (options->headless && options->frames == 0) options->frames = HEADLESS_DEFAULT_FRAMES;
+    return true;
+}
+
+// Close whichever display main() opened
+static void close_display(RGFW_window* win, HeadlessContext* headless) {
+    if (win) RGFW_window_close(win);
+    headless_destroy(headless);
+}
+
+// Window surface over the software renderer's pixels; recreated whenever
+// they are reallocated (resize)
+static RGFW_surface* create_surface(RGFW_window* win, const Renderer* renderer) {
+    const SoftRenderer* sr = renderer->software;
+    RGFW_surface* surface = RGFW_window_createSurface(win, (u8*)sr->pixels, sr->viewport_width,
+                                                      sr->viewport_height, RGFW_formatBGRA8);
+    if (!surface) printf("Error: Failed to create window surface\n");
+    return surface;
+}
+
+// Redistribute the particles of the active backend (gpu = NULL: CPU)
+static void redistribute(ParticleSystem* ps, GpuParticles* gpu, const Config* config, const Camera* camera,
+                         bool grid) {
+    if (gpu) {
+        gpu_particles_redistribute(gpu, config, camera, grid);
+    } else if (grid) {
+        particle_system_redistribute_grid(ps, config, camera);
+    } else {
+        particle_system_redistribute(ps, config, camera);
     }
-    
-    float delta = (float)(current_time - last_time) / CLOCKS_PER_SEC;
-    last_time = current_time;
-    
-    return delta;
 }
 
 // Handle keyboard input
-void handle_input(RGFW_window* win, RGFW_keyEvent* event, Config* config, Renderer* renderer, ParticleSystem* ps, Camera* camera) {
+void handle_input(RGFW_window* win, RGFW_keyEvent* event, Config* config, Renderer* renderer, ParticleSystem* ps,
+                  GpuParticles* gpu, Camera* camera) {
     switch (event->value) {
         case RGFW_space:
             // Toggle pause
@@ -48,7 +114,7 @@ void handle_input(RGFW_window* win, RGFW_keyEvent* event, Config* config, Render
             
         case RGFW_r:
             // Reset particles
-            particle_system_redistribute_grid(ps, config, camera);
+            redistribute(ps, gpu, config, camera, true);
             printf("Particles reset\n");
             break;
             
@@ -63,7 +129,7 @@ void handle_input(RGFW_window* win, RGFW_keyEvent* event, Config* config, Render
         case RGFW_9:
             config->vector_field_num = event->value - RGFW_1;
             printf("%d", event->value - RGFW_1);
-            particle_system_redistribute(ps, config, camera);
+            redistribute(ps, gpu, config, camera, false);
             renderer_request_clear(renderer);  // Clear on next frame
             printf("Vector field: %d\n", config->vector_field_num);
             break;
@@ -74,7 +140,7 @@ void handle_input(RGFW_window* win, RGFW_keyEvent* event, Config* config, Render
             camera_zoom_in(camera);
             // Always redistribute on any zoom change
             if (camera->zoom != old_zoom) {
-                particle_system_redistribute(ps, config, camera);
+                redistribute(ps, gpu, config, camera, false);
                 printf("Zoom: %.2f (redistributed)\n", camera->zoom);
             }
             break;
@@ -86,7 +152,7 @@ void handle_input(RGFW_window* win, RGFW_keyEvent* event, Config* config, Render
             camera_zoom_out(camera);
             // Always redistribute on any zoom change
             if (camera->zoom != old_zoom) {
-                particle_system_redistribute(ps, config, camera);
+                redistribute(ps, gpu, config, camera, false);
                 printf("Zoom: %.2f (redistributed)\n", camera->zoom);
             }
             break;
@@ -121,13 +187,29 @@ void handle_input(RGFW_window* win, RGFW_keyEvent* event, Config* config, Render
             break;
     }
 }
-int main(void) {
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, &options)) return 1;
     printf("prox1\n");
     
     // Load or create default configuration
     Config config = config_create_default();
     config_load_from_file(&config, "config.ini");
     config_print(&config);
+    printf("Field kernels: %s\n", vector_field_simd_name(vector_field_detect_simd()));
+    
+    // The software renderer draws into a window's buffer from CPU particles
+    bool software = config.render_backend == RENDER_BACKEND_SOFTWARE;
+    if (software && options.headless) {
+        printf("Warning: render_backend = software needs a window, using opengl\n");
+        software = false;
+    }
+    if (software && config.simulation_backend != SIMULATION_CPU) {
+        printf("Warning: GPU simulation needs render_backend = opengl, using the CPU\n");
+    }
+    if (software && config.trail_length >= 2) {
+        printf("Warning: trails need render_backend = opengl, fading instead\n");
+    }
 
     // OpenGL version
     // RGFW_glHints* hints = RGFW_getGlobalHints_OpenGL();
@@ -135,52 +217,107 @@ int main(void) {
     // hints->minor = 3;
     // RGFW_setGlobalHints_OpenGL(hints);
     
-    // Create RGFW window
-    RGFW_window* win = RGFW_createWindow(
-        "prox1",
-        0, 0, config.window_width, config.window_height,
-        RGFW_windowCenter | RGFW_windowAllowDND | RGFW_windowOpenGL
-    );
-    
-    if (!win) {
-        printf("Error: Failed to create window\n");
-        return 1;
-    }
+    // Create RGFW window, or render off-screen at the window's size
+    RGFW_window* win = NULL;
+    HeadlessContext* headless = NULL;
+    if (options.headless) {
+        headless = headless_create(config.window_width, config.window_height);
+        if (!headless) {
+            printf("Error: Failed to create headless context\n");
+            return 1;
+        }
+    } else {
+        win = RGFW_createWindow(
+            "prox1",
+            0, 0, config.window_width, config.window_height,
+            RGFW_windowCenter | RGFW_windowAllowDND | (software ? 0 : RGFW_windowOpenGL)
+        );
+        
+        if (!win) {
+            printf("Error: Failed to create window\n");
+            return 1;
+        }
 
-    RGFW_window_swapInterval_OpenGL(win, 1); // VSync
+        if (!software) RGFW_window_swapInterval_OpenGL(win, 1); // VSync
+    }
 
     Camera camera = camera_create();
     
-    Renderer* renderer = renderer_create();
-    if (!renderer_init(renderer, config.window_width, config.window_height)) {
+    // Workers are shared by the particle update and the vertex build
+    ThreadPool* pool = thread_pool_create(config.threads);
+    
+    Renderer* renderer = renderer_create(pool);
+    bool initialized = software ? renderer_init_software(renderer, config.window_width, config.window_height)
+                                : renderer_init(renderer, config.window_width, config.window_height);
+    RGFW_surface* surface = software && initialized ? create_surface(win, renderer) : NULL;
+    if (!initialized || (software && !surface)) {
         printf("Error: Failed to initialize renderer\n");
-        RGFW_window_close(win);
+        renderer_destroy(renderer);
+        thread_pool_destroy(pool);
+        close_display(win, headless);
         return 1;
     }
     
-    ParticleSystem* ps = particle_system_create(config.particle_count);
-    if (!ps) {
-        printf("Error: Failed to create particle system\n");
-        renderer_destroy(renderer);
-        RGFW_window_close(win);
-        return 1;
+    // GPU backends: particles live in GPU buffers; fall back to the CPU
+    // where the context can't run them
+    GpuParticles* gpu = NULL;
+    ParticleSystem* ps = NULL;
+    if (config.simulation_backend != SIMULATION_CPU && !software) {
+        gpu = gpu_particles_create(config.particle_count, config.random_seed,
+                                   config.simulation_backend == SIMULATION_FEEDBACK);
+        if (!gpu) printf("Warning: GPU simulation unavailable, using the CPU\n");
+    }
+    if (!gpu) {
+        ps = particle_system_create(config.particle_count, config.random_seed, pool);
+        if (!ps) {
+            printf("Error: Failed to create particle system\n");
+            if (surface) RGFW_surface_free(surface);
+            renderer_destroy(renderer);
+            thread_pool_destroy(pool);
+            close_display(win, headless);
+            return 1;
+        }
     }
     
-    particle_system_redistribute_grid(ps, &config, &camera);
+    redistribute(ps, gpu, &config, &camera, true);
     
-    printf("SPACE   - Pause/Resume\n");
-    printf("R       - Reset particles\n");
-    printf("1-5     - Switch vector field\n");
-    printf("W/A/S/D - Camera movement\n");
-    printf("+/-     - Zoom / Outzoom \n");
-    printf("C       - Reset camera \n");
-    printf("ESC     - Exit\n");
+    if (win) {
+        printf("SPACE   - Pause/Resume\n");
+        printf("R       - Reset particles\n");
+        printf("1-5     - Switch vector field\n");
+        printf("W/A/S/D - Camera movement\n");
+        printf("+/-     - Zoom / Outzoom \n");
+        printf("C       - Reset camera \n");
+        printf("ESC     - Exit\n");
+    }
     
-    while (RGFW_window_shouldClose(win) == RGFW_FALSE) {
-        float dt = get_delta_time();
-
+    // Offline rendering: every frame is read back and written out
+    FrameCapture* capture = NULL;
+    if (options.render) {
+        capture = frame_capture_create(config.window_width, config.window_height, options.out);
+        if (!capture) {
+            printf("Error: Failed to create frame capture\n");
+            particle_system_destroy(ps);
+            gpu_particles_destroy(gpu);
+            renderer_destroy(renderer);
+            thread_pool_destroy(pool);
+            close_display(win, headless);
+            return 1;
+        }
+    }
+    
+    // Simulation runs at a fixed rate; rendering interpolates between steps.
+    // Offline frames advance exactly 1/fps and may take any number of steps.
+    int max_substeps = config.max_substeps;
+    if (options.render) max_substeps = (int)ceilf(config.simulation_rate / options.fps) + 1;
+    SimClock sim_clock = sim_clock_create(config.simulation_rate, max_substeps);
+    int frame = 0;
+    bool failed = false;
+    double start_time = sim_clock_now();
+    
+    while (!(win && RGFW_window_shouldClose(win)) && (options.frames == 0 || frame < options.frames)) {
         RGFW_event event;
-        while (RGFW_window_checkEvent(win, &event)) {
+        while (win && RGFW_window_checkEvent(win, &event)) {
             if (event.type == RGFW_quit) {
                 break;
             }
@@ -189,28 +326,86 @@ int main(void) {
                 config.window_width = win->w;
                 config.window_height = win->h;
                 renderer_set_viewport(renderer, win->w, win->h);
+                if (surface) {
+                    RGFW_surface_free(surface);
+                    surface = create_surface(win, renderer);
+                    if (!surface) {
+                        failed = true;
+                        win->internal.shouldClose = 1;
+                    }
+                }
                 printf("Window resized: %dx%d\n", win->w, win->h);
             }
 
             if (event.type == RGFW_keyPressed) {
-                handle_input(win, (RGFW_keyEvent*)&event, &config, renderer, ps, &camera);
+                handle_input(win, (RGFW_keyEvent*)&event, &config, renderer, ps, gpu, &camera);
             }
         }
         
-        particle_system_update(ps, &config, &camera, dt);
-
-        renderer_update_particles(renderer, ps);
-        renderer_draw(renderer, ps, &config, &camera);
-        RGFW_window_swapBuffers_OpenGL(win);
+        int steps = options.render ? sim_clock_advance_by(&sim_clock, 1.0 / options.fps, config.paused)
+                                   : sim_clock_advance(&sim_clock, config.paused);
+        if (gpu) {
+            // Steps and vertex records stay on the GPU
+            for (int i = 0; i < steps; i++) {
+                gpu_particles_update(gpu, &config, &camera, sim_clock.step);
+            }
+            gpu_particles_emit(gpu, &config, &camera, sim_clock.alpha);
+            renderer_attach_particles(renderer, gpu->records, gpu->mode, gpu->count);
+        } else {
+            bool emitted = false;
+            for (int i = 0; i < steps; i++) {
+                // The last step writes the frame's vertices as its batches finish
+                ParticleEmitter emitter;
+                if (i == steps - 1 && config.fused_emit &&
+                    renderer_begin_particles(renderer, ps, &config, &camera, sim_clock.alpha, &emitter)) {
+                    particle_system_update_emit(ps, &config, &camera, sim_clock.step, &emitter);
+                    renderer_end_particles(renderer);
+                    emitted = true;
+                } else {
+                    particle_system_update(ps, &config, &camera, sim_clock.step);
+                }
+                renderer_record_trails(renderer, ps, &config);
+            }
+            
+            // No step this frame (paused, or between steps): rebuild at the new alpha
+            if (!emitted) renderer_update_particles(renderer, ps, &config, &camera, sim_clock.alpha);
+        }
+        renderer_draw(renderer, ps, &config, &camera, sim_clock.elapsed);
+        if (software) {
+            if (surface) RGFW_window_blitSurface(win, surface);
+        } else if (win) {
+            RGFW_window_swapBuffers_OpenGL(win);
+        } else {
+            glFlush();
+        }
+        if (capture && !frame_capture_push(capture, headless->framebuffer, frame)) {
+            failed = true;
+            break;
+        }
+        frame++;
+    }
+    
+    if (capture) {
+        if (!frame_capture_finish(capture)) failed = true;
+        printf("Frames written: %d to '%s'\n", capture->written, options.out);
+        frame_capture_destroy(capture);
+    }
+    if (options.frames > 0) {
+        if (!software) glFinish();
+        double seconds = sim_clock_now() - start_time;
+        printf("Frames: %d in %.2f s (%.1f fps)\n", frame, seconds, seconds > 0.0 ? frame / seconds : 0.0);
     }
     
     // Cleanup
     particle_system_destroy(ps);
+    gpu_particles_destroy(gpu);
+    if (surface) RGFW_surface_free(surface);
     renderer_destroy(renderer);
-    RGFW_window_close(win);
+    thread_pool_destroy(pool);
+    close_display(win, headless);
     
-    // Save configuration
-    config_save_to_file(&config, "config.ini");
+    // Save configuration (a headless run can't change it)
+    if (win) config_save_to_file(&config, "config.ini");
 
-    return 0;
+    return failed ? 1 : 0;
 }
\ No newline at end of file
@@ -1,4 +1,9 @@
+#define _POSIX_C_SOURCE 200112L  // posix_memalign
+
 #include "particles.h"
+#include "rng.h"
+#include "integrator.h"
+#include "simd.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -6,16 +11,6 @@
 #include <time.h>
 #include <math.h>
 
-// Random float between 0 and 1
-static inline float randf() {
-    return (float)rand() / (float)RAND_MAX;
-}
-
-// Random float between min and max
-static inline float randf_range(float min, float max) {
-    return min + randf() * (max - min);
-}
-
 // Fast inverse square root (pure magic)
 static inline float fast_inv_sqrt(float x) {
     float xhalf = 0.5f * x;
@@ -26,6 +21,38 @@ static inline float fast_inv_sqrt(float x) {
     return x;
 }
 
+// Particles integrated per field batch
+#define PARTICLE_BATCH INTEGRATOR_MAX_BATCH
+
+// Smallest pool chunk worth handing to another thread
+#define PARTICLE_MIN_CHUNK 1024
+
+// Fewest steps between two sorts triggered by disorder. A sort costs a few
+// steps of cached updates; particles fast enough to undo it sooner would
+// otherwise re-sort every few steps for nothing.
+#define SORT_MIN_SPACING 30
+
+// Multirate stepping: slow particles are integrated every 2^level frames,
+// level < MULTIRATE_LEVELS (intervals 1, 2, 4, 8)
+#define MULTIRATE_LEVELS 4
+
+// Particles are scheduled in aligned groups, so every step integrates a
+// contiguous range (the sort keeps neighbors in a group at similar speeds)
+#define MULTIRATE_GROUP THREAD_POOL_CHUNK_ALIGN
+
+// Upper bound of the zoom-dependent particle count
+#define PARTICLE_MAX_COUNT 200000
+
+// Respawn weight of a cell: its deficit below the mean count plus a floor
+// (as a fraction of the mean), so no visible cell is ever left out
+#define OCCUPANCY_FLOOR 0.1f
+
+// Cells holding more than this multiple of the mean count are crowded
+#define OCCUPANCY_CROWDED 1.25f
+
+// Fraction of a crowded cell's excess recycled per step
+#define OCCUPANCY_RECYCLE_RATE 0.05f
+
 // Build view cache once per frame
 static inline void build_view_cache(ViewCache* cache, const Camera* cam) {
     camera_get_view_bounds(cam, &cache->left, &cache->right, &cache->bottom, &cache->top);
@@ -35,55 +62,188 @@ static inline void build_view_cache(ViewCache* cache, const Camera* cam) {
     cache->margin_y = cache->view_height * 0.15f;
 }
 
-// Random spawn within camera view
-static void particle_reset_in_view(Particle* p, const Config* config, const ViewCache* cache) {
-    p->position.x = randf_range(cache->left, cache->right);
-    p->position.y = randf_range(cache->bottom, cache->top);
-    p->prev_position = p->position;
-    p->lifetime = 0.0f;
+// Map a uniform [0, 1) sample into [min, max)
+static inline float lerp_range(float u, float min, float max) {
+    return min + u * (max - min);
+}
+
+// Start a new generation of particle i (it was just (re)spawned at x, y):
+// its next frame segment starts at the spawn point
+static inline void particle_mark_spawn(ParticleSystem* ps, int i, float x, float y) {
+    float generation = ps->generation[i] + 1.0f;
+    ps->generation[i] = generation < (float)PARTICLE_GENERATIONS ? generation : 0.0f;
+    ps->frame_x[i] = x;
+    ps->frame_y[i] = y;
+}
+
+// Random spawn within camera view (u0, u1 uniform in [0, 1))
+static void particle_reset_in_view(ParticleSystem* ps, int i, const ViewCache* cache, float u0, float u1) {
+    ps->x[i] = lerp_range(u0, cache->left, cache->right);
+    ps->y[i] = lerp_range(u1, cache->bottom, cache->top);
+    ps->prev_x[i] = ps->x[i];
+    ps->prev_y[i] = ps->y[i];
+    ps->lifetime[i] = 0.0f;
+    ps->step[i] = 0.0f;
+    ps->coast[i] = -1.0f;
+    particle_mark_spawn(ps, i, ps->x[i], ps->y[i]);
+}
+
+// =============================================================================
+// Occupancy Grid
+// =============================================================================
+
+// Cell of a position (positions in the view margin clamp to the edge cells)
+static inline int occupancy_cell(float x, float y, const ViewCache* cache, float cells_per_x, float cells_per_y) {
+    int cx = (int)((x - cache->left) * cells_per_x);
+    int cy = (int)((y - cache->bottom) * cells_per_y);
+    cx = cx < 0 ? 0 : (cx >= OCCUPANCY_GRID_X ? OCCUPANCY_GRID_X - 1 : cx);
+    cy = cy < 0 ? 0 : (cy >= OCCUPANCY_GRID_Y ? OCCUPANCY_GRID_Y - 1 : cy);
+    return cy * OCCUPANCY_GRID_X + cx;
+}
+
+// Spawn position from three uniforms: u[0] picks a cell through the alias
+// table (integer part: column, fraction: keep test), u[1] and u[2] place
+// the particle inside it. Uniform over the view until the first histogram.
+static inline void occupancy_sample(const OccupancyGrid* grid, const ViewCache* cache, const float u[3],
+                                    float* x, float* y) {
+    if (!grid->valid) {
+        *x = lerp_range(u[1], cache->left, cache->right);
+        *y = lerp_range(u[2], cache->bottom, cache->top);
+        return;
+    }
+    
+    float scaled = u[0] * OCCUPANCY_CELLS;
+    int column = (int)scaled;
+    if (column >= OCCUPANCY_CELLS) column = OCCUPANCY_CELLS - 1;
+    int cell = (scaled - column) < grid->prob[column] ? column : grid->alias[column];
+    
+    int cx = cell % OCCUPANCY_GRID_X;
+    int cy = cell / OCCUPANCY_GRID_X;
+    *x = cache->left + ((float)cx + u[1]) * (cache->view_width / OCCUPANCY_GRID_X);
+    *y = cache->bottom + ((float)cy + u[2]) * (cache->view_height / OCCUPANCY_GRID_Y);
 }
 
-// Update particle color based on velocity
-static inline void update_particle_color(Particle* p, vec2 velocity) {
-    // Use squared speed to avoid sqrt
-    float speed_sq = velocity.x * velocity.x + velocity.y * velocity.y;
+// Sum the per-worker histograms of the last update and rebuild the spawn
+// alias table (Vose's method) and the recycle probabilities from them
+static void occupancy_rebuild(OccupancyGrid* grid) {
+    int counts[OCCUPANCY_CELLS] = {0};
+    long total = 0;
+    
+    for (int w = 0; w < grid->workers; w++) {
+        int* row = grid->counts + (size_t)w * OCCUPANCY_CELLS;
+        for (int c = 0; c < OCCUPANCY_CELLS; c++) {
+            counts[c] += row[c];
+        }
+        memset(row, 0, sizeof(int) * OCCUPANCY_CELLS);
+    }
+    for (int c = 0; c < OCCUPANCY_CELLS; c++) {
+        total += counts[c];
+    }
+    
+    long changes = 0;
+    for (int w = 0; w < grid->workers; w++) {
+        changes += grid->changes[w * OCCUPANCY_WORKER_STRIDE];
+        grid->changes[w * OCCUPANCY_WORKER_STRIDE] = 0;
+    }
     
-    // Normalize against squared threshold (2.0^2 = 4.0)
-    float speed_normalized = fminf(speed_sq * 0.25f, 1.0f);  // *0.25 = /4.0
+    grid->valid = total > 0;
+    if (!grid->valid) return;
     
-    if (speed_normalized < 0.5f) {
-        float t = speed_normalized * 2.0f;
-        p->color[0] = 0.0f;
-        p->color[1] = 0.5f + t * 0.5f;
-        p->color[2] = 1.0f;
-    } else {
-        float t = (speed_normalized - 0.5f) * 2.0f;
-        p->color[0] = t;
-        p->color[1] = 1.0f - t * 0.3f;
-        p->color[2] = 1.0f - t;
+    // Neighbor pairs that were compared (all but the first of each group)
+    long pairs = total - (total + THREAD_POOL_CHUNK_ALIGN - 1) / THREAD_POOL_CHUNK_ALIGN;
+    grid->disorder = pairs > 0 ? (float)changes / (float)pairs : 0.0f;
+    
+    float mean = (float)total / OCCUPANCY_CELLS;
+    float crowded = mean * OCCUPANCY_CROWDED;
+    
+    // Spawn weights, scaled so they average 1
+    float weight[OCCUPANCY_CELLS];
+    float weight_sum = 0.0f;
+    for (int c = 0; c < OCCUPANCY_CELLS; c++) {
+        float deficit = mean - (float)counts[c];
+        weight[c] = (deficit > 0.0f ? deficit : 0.0f) + mean * OCCUPANCY_FLOOR;
+        weight_sum += weight[c];
+        
+        grid->recycle[c] = counts[c] > crowded ?
+            OCCUPANCY_RECYCLE_RATE * ((float)counts[c] - crowded) / (float)counts[c] : 0.0f;
+    }
+    
+    // Pair every under-full column with an over-full cell
+    int small[OCCUPANCY_CELLS], large[OCCUPANCY_CELLS];
+    int small_count = 0, large_count = 0;
+    for (int c = 0; c < OCCUPANCY_CELLS; c++) {
+        weight[c] *= OCCUPANCY_CELLS / weight_sum;
+        if (weight[c] < 1.0f) {
+            small[small_count++] = c;
+        } else {
+            large[large_count++] = c;
+        }
     }
     
-    p->color[3] = 0.3f;
+    while (small_count > 0 && large_count > 0) {
+        int s = small[--small_count];
+        int l = large[--large_count];
+        grid->prob[s] = weight[s];
+        grid->alias[s] = l;
+        weight[l] -= 1.0f - weight[s];
+        if (weight[l] < 1.0f) {
+            small[small_count++] = l;
+        } else {
+            large[large_count++] = l;
+        }
+    }
+    
+    // Leftovers are 1 up to rounding
+    while (large_count > 0) {
+        int l = large[--large_count];
+        grid->prob[l] = 1.0f;
+        grid->alias[l] = l;
+    }
+    while (small_count > 0) {
+        int s = small[--small_count];
+        grid->prob[s] = 1.0f;
+        grid->alias[s] = s;
+    }
 }
 
 // Check if particle is outside camera view (uses cached bounds)
-static inline bool is_particle_outside_view(const Particle* p, const ViewCache* cache) {
-    return (p->position.x < cache->left - cache->margin_x || 
-            p->position.x > cache->right + cache->margin_x ||
-            p->position.y < cache->bottom - cache->margin_y || 
-            p->position.y > cache->top + cache->margin_y);
+static inline bool is_particle_outside_view(float x, float y, const ViewCache* cache) {
+    return (x < cache->left - cache->margin_x || 
+            x > cache->right + cache->margin_x ||
+            y < cache->bottom - cache->margin_y || 
+            y > cache->top + cache->margin_y);
+}
+
+// Allocate one cache-aligned particle array
+static float* particle_array_alloc(int capacity) {
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, PARTICLE_ALIGNMENT, sizeof(float) * capacity) != 0) {
+        return NULL;
+    }
+    return (float*)ptr;
+}
+
+static void particle_arrays_free(ParticleSystem* ps) {
+#define X(name) free(ps->name); ps->name = NULL;
+    PARTICLE_ARRAYS(X)
+#undef X
 }
 
 // Create particle system
-ParticleSystem* particle_system_create(int initial_capacity) {
-    ParticleSystem* ps = (ParticleSystem*)malloc(sizeof(ParticleSystem));
+ParticleSystem* particle_system_create(int initial_capacity, unsigned int seed, ThreadPool* pool) {
+    ParticleSystem* ps = (ParticleSystem*)calloc(1, sizeof(ParticleSystem));
     if (!ps) {
         fprintf(stderr, "Error: Failed to allocate particle system\n");
         return NULL;
     }
     
-    ps->particles = (Particle*)malloc(sizeof(Particle) * initial_capacity);
-    if (!ps->particles) {
+    bool allocated = true;
+#define X(name) ps->name = particle_array_alloc(initial_capacity); allocated = allocated && ps->name;
+    PARTICLE_ARRAYS(X)
+#undef X
+    
+    if (!allocated) {
+        particle_arrays_free(ps);
         free(ps);
         fprintf(stderr, "Error: Failed to allocate particles\n");
         return NULL;
@@ -92,8 +252,30 @@ ParticleSystem* particle_system_create(int initial_capacity) {
     ps->count = initial_capacity;
     ps->capacity = initial_capacity;
     ps->target_count = initial_capacity;
+    for (int i = 0; i < initial_capacity; i++) {
+        ps->trail_slot[i] = (float)i;
+        ps->generation[i] = 0.0f;
+    }
+    ps->pool = pool;
+    
+    // Seed 0 picks one from the clock; print it so the run can be repeated
+    ps->seed = seed ? seed : (unsigned int)time(NULL);
+    ps->frame = 0;
+    printf("Particle random seed: %u\n", ps->seed);
+    
+    // One histogram row per worker, so the update never shares counters
+    ps->occupancy.workers = thread_pool_size(pool);
+    ps->occupancy.counts = (int*)calloc((size_t)ps->occupancy.workers * OCCUPANCY_CELLS, sizeof(int));
+    ps->occupancy.changes = (int*)calloc((size_t)ps->occupancy.workers * OCCUPANCY_WORKER_STRIDE, sizeof(int));
+    if (!ps->occupancy.counts || !ps->occupancy.changes) {
+        particle_arrays_free(ps);
+        free(ps->occupancy.counts);
+        free(ps->occupancy.changes);
+        free(ps);
+        fprintf(stderr, "Error: Failed to allocate occupancy grid\n");
+        return NULL;
+    }
     
-    srand((unsigned int)time(NULL));
     return ps;
 }
 
@@ -103,145 +285,671 @@ void particle_system_resize(ParticleSystem* ps, int new_count) {
     // Use growth factor to reduce realloc calls (1.5x strategy)
     if (new_count > ps->capacity) {
         int new_capacity = (int)(new_count * 1.5f);
-        Particle* new_particles = (Particle*)realloc(ps->particles, sizeof(Particle) * new_capacity);
-        if (!new_particles) {
+        
+        // No aligned realloc: allocate every array first so a failure
+        // leaves the system untouched, then copy the live range over
+        bool allocated = true;
+#define X(name) float* new_##name = particle_array_alloc(new_capacity); allocated = allocated && new_##name;
+        PARTICLE_ARRAYS(X)
+#undef X
+        
+        if (!allocated) {
+#define X(name) free(new_##name);
+            PARTICLE_ARRAYS(X)
+#undef X
             fprintf(stderr, "Error: Failed to resize particle array\n");
             return;
         }
-        ps->particles = new_particles;
+        
+#define X(name) \
+        memcpy(new_##name, ps->name, sizeof(float) * ps->count); \
+        free(ps->name); \
+        ps->name = new_##name;
+        PARTICLE_ARRAYS(X)
+#undef X
         ps->capacity = new_capacity;
     }
     
+    // New particles take the next trail columns. Dropping particles leaves
+    // holes in the columns, so shrinking renumbers them (trails restart).
+    int first = new_count < ps->count ? 0 : ps->count;
+    for (int i = first; i < new_count; i++) ps->trail_slot[i] = (float)i;
+    for (int i = ps->count; i < new_count; i++) {
+        ps->generation[i] = 0.0f;
+        ps->frame_x[i] = ps->x[i];
+        ps->frame_y[i] = ps->y[i];
+    }
+    
     ps->count = new_count;
 }
 
+// Shared state of the parallel redistribute jobs
+typedef struct {
+    ParticleSystem* ps;
+    ViewCache cache;
+    float lifetime_mult;
+    int grid_size;
+} RedistributeJob;
+
+static void redistribute_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    RedistributeJob* job = (RedistributeJob*)ctx;
+    ParticleSystem* ps = job->ps;
+    
+    for (int i = begin; i < end; i++) {
+        float u[4];
+        rng_uniform4(ps->seed, i, ps->frame, RNG_STREAM_REDISTRIBUTE, u);
+        particle_reset_in_view(ps, i, &job->cache, u[0], u[1]);
+        ps->lifetime[i] = u[2] * job->lifetime_mult;
+    }
+}
+
 // Random redistribution
 void particle_system_redistribute(ParticleSystem* ps, const Config* config, const Camera* cam) {
-    ViewCache cache;
-    build_view_cache(&cache, cam);
+    RedistributeJob job;
+    job.ps = ps;
+    build_view_cache(&job.cache, cam);
+    job.lifetime_mult = config->particle_lifetime * 0.5f;
+    job.grid_size = 0;
     
-    float lifetime_mult = config->particle_lifetime * 0.5f;
+    thread_pool_run(ps->pool, ps->count, PARTICLE_MIN_CHUNK, redistribute_chunk, &job);
+}
+
+static void redistribute_grid_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    RedistributeJob* job = (RedistributeJob*)ctx;
+    ParticleSystem* ps = job->ps;
+    const ViewCache* cache = &job->cache;
+    
+    int grid_size = job->grid_size;
+    int grid_cells = grid_size * grid_size;
+    float step_x = cache->view_width / grid_size;
+    float step_y = cache->view_height / grid_size;
     
-    for (int i = 0; i < ps->count; i++) {
-        particle_reset_in_view(&ps->particles[i], config, &cache);
-        ps->particles[i].lifetime = randf() * lifetime_mult;
+    for (int idx = begin; idx < end; idx++) {
+        float u[4];
+        rng_uniform4(ps->seed, idx, ps->frame, RNG_STREAM_GRID, u);
+        
+        if (idx < grid_cells) {
+            // Cell (i, j) in the order of the original nested loop
+            int i = idx / grid_size;
+            int j = idx % grid_size;
+            
+            // Jittered grid: add random offset from cell center
+            float jitter_x = (u[0] - 0.5f) * step_x * 0.8f;
+            float jitter_y = (u[1] - 0.5f) * step_y * 0.8f;
+            
+            ps->x[idx] = cache->left + (i + 0.5f) * step_x + jitter_x;
+            ps->y[idx] = cache->bottom + (j + 0.5f) * step_y + jitter_y;
+        } else {
+            // Fill remaining particles with pure random distribution
+            ps->x[idx] = lerp_range(u[0], cache->left, cache->right);
+            ps->y[idx] = lerp_range(u[1], cache->bottom, cache->top);
+        }
+        ps->prev_x[idx] = ps->x[idx];
+        ps->prev_y[idx] = ps->y[idx];
+        ps->lifetime[idx] = u[2] * job->lifetime_mult;
+        ps->step[idx] = 0.0f;
+        ps->coast[idx] = -1.0f;
+        particle_mark_spawn(ps, idx, ps->x[idx], ps->y[idx]);
     }
 }
 
 // Grid-based redistribution
 void particle_system_redistribute_grid(ParticleSystem* ps, const Config* config, const Camera* cam) {
-    ViewCache cache;
-    build_view_cache(&cache, cam);
+    RedistributeJob job;
+    job.ps = ps;
+    build_view_cache(&job.cache, cam);
     
-    int grid_size = (int)sqrtf((float)ps->count);
+    // Use Poisson disk-like distribution for better spacing
+    job.grid_size = (int)sqrtf((float)ps->count);
     
     // Pre-calculate lifetime multiplier
-    float lifetime_mult = config->particle_lifetime * 0.3f;
+    job.lifetime_mult = config->particle_lifetime * 0.3f;
     
-    int idx = 0;
+    thread_pool_run(ps->pool, ps->count, PARTICLE_MIN_CHUNK, redistribute_grid_chunk, &job);
+}
+
+// Shared state of one parallel update
+typedef struct {
+    ParticleSystem* ps;
+    const Config* config;
+    VectorFieldEvaluator field;
+    IntegratorParams integrator;
+    const FieldCache* flow_map;      // Advance by flow map lookups (NULL = integrate)
+    int multirate_levels;            // Highest multirate level (0 = every particle every frame)
+    float multirate_speed[MULTIRATE_LEVELS];  // Normalized speed below which a level is allowed
+    ViewCache cache;
+    float cells_per_x, cells_per_y;  // Occupancy cells per world unit
+    const ParticleEmitter* emitter;  // Takes finished batches (NULL = none)
+} UpdateJob;
+
+// Occupancy cells of n particles of a batch
+static void occupancy_cells(const UpdateJob* job, const float* x, const float* y, int n, int32_t* cell) {
+    const ViewCache* cache = &job->cache;
+    vf left = vf_set1(cache->left);
+    vf bottom = vf_set1(cache->bottom);
+    vf cells_per_x = vf_set1(job->cells_per_x);
+    vf cells_per_y = vf_set1(job->cells_per_y);
+    vf last_x = vf_set1((float)(OCCUPANCY_GRID_X - 1));
+    vf last_y = vf_set1((float)(OCCUPANCY_GRID_Y - 1));
+    vf zero = vf_set1(0.0f);
+    vf half = vf_set1(0.5f);
     
-    // Use Poisson disk-like distribution for better spacing
-    for (int i = 0; i < grid_size && idx < ps->count; i++) {
-        for (int j = 0; j < grid_size && idx < ps->count; j++) {
-            float step_x = cache.view_width / grid_size;
-            float step_y = cache.view_height / grid_size;
+    int full = SIMD_FLOOR(n);
+    for (int i = 0; i < full; i += SIMD_WIDTH) {
+        // Clamped first: NaN and margin positions land in edge cells
+        vf fx = vf_min(vf_max(vf_mul(vf_sub(vf_load(x + i), left), cells_per_x), zero), last_x);
+        vf fy = vf_min(vf_max(vf_mul(vf_sub(vf_load(y + i), bottom), cells_per_y), zero), last_y);
+        
+        // Both are >= 0, so rounding v - 0.5 floors them (ties may go one
+        // cell down, which doesn't matter for a histogram)
+        vf cx = vi_to_vf(vf_round_vi(vf_sub(fx, half)));
+        vf cy = vi_to_vf(vf_round_vi(vf_sub(fy, half)));
+        vi_store(cell + i, vf_round_vi(vf_fmadd(cy, vf_set1((float)OCCUPANCY_GRID_X), cx)));
+    }
+    for (int i = full; i < n; i++) {
+        cell[i] = occupancy_cell(x[i], y[i], cache, job->cells_per_x, job->cells_per_y);
+    }
+}
+
+// Fastest particle and smallest coast count of particles [begin, end)
+static inline void multirate_group_scan(const ParticleSystem* ps, int begin, int end,
+                                        float* fastest, float* soonest) {
+    float lanes[2][SIMD_WIDTH];
+    int full = begin + SIMD_FLOOR(end - begin);
+    vf max_speed = vf_set1(0.0f);
+    vf min_coast = vf_set1((float)MULTIRATE_GROUP);
+    for (int i = begin; i < full; i += SIMD_WIDTH) {
+        max_speed = vf_max(max_speed, vf_load(ps->speed + i));
+        min_coast = vf_min(min_coast, vf_load(ps->coast + i));
+    }
+    vf_store(lanes[0], max_speed);
+    vf_store(lanes[1], min_coast);
+    
+    float max_s = 0.0f, min_c = (float)MULTIRATE_GROUP;
+    for (int k = 0; k < SIMD_WIDTH; k++) {
+        max_s = lanes[0][k] > max_s ? lanes[0][k] : max_s;
+        min_c = lanes[1][k] < min_c ? lanes[1][k] : min_c;
+    }
+    for (int i = full; i < end; i++) {
+        max_s = ps->speed[i] > max_s ? ps->speed[i] : max_s;
+        min_c = ps->coast[i] < min_c ? ps->coast[i] : min_c;
+    }
+    *fastest = max_s;
+    *soonest = min_c;
+}
+
+// Particles [begin, end) repeat their last displacement
+static inline void multirate_coast(ParticleSystem* ps, int begin, int end) {
+    float* restrict px = ps->x;
+    float* restrict py = ps->y;
+    float* restrict prev_x = ps->prev_x;
+    float* restrict prev_y = ps->prev_y;
+    float* restrict coast = ps->coast;
+    
+    int full = begin + SIMD_FLOOR(end - begin);
+    for (int i = begin; i < full; i += SIMD_WIDTH) {
+        vf x = vf_load(px + i);
+        vf y = vf_load(py + i);
+        vf_store(px + i, vf_sub(vf_add(x, x), vf_load(prev_x + i)));
+        vf_store(py + i, vf_sub(vf_add(y, y), vf_load(prev_y + i)));
+        vf_store(prev_x + i, x);
+        vf_store(prev_y + i, y);
+        vf_store(coast + i, vf_sub(vf_load(coast + i), vf_set1(1.0f)));
+    }
+    for (int i = full; i < end; i++) {
+        float x = px[i], y = py[i];
+        px[i] = x + (x - prev_x[i]);
+        py[i] = y + (y - prev_y[i]);
+        prev_x[i] = x;
+        prev_y[i] = y;
+        coast[i] -= 1.0f;
+    }
+}
+
+// Multirate advance of particles [base, base + n), in aligned groups of
+// MULTIRATE_GROUP. A group is integrated once any of its particles is due,
+// over 2^level frames for the level its fastest particle allows, and moves
+// 1/2^level of the way this frame; other groups repeat their last
+// displacement. A step of 2^level frames starts only on a frame where
+// frame + group is a multiple of it, which spreads the steps of slow groups
+// evenly over the frames.
+static void advance_multirate(const UpdateJob* job, int base, int n) {
+    ParticleSystem* ps = job->ps;
+    int groups = (n + MULTIRATE_GROUP - 1) / MULTIRATE_GROUP;
+    int level[PARTICLE_BATCH / MULTIRATE_GROUP];  // -1 = coasting
+    
+    for (int g = 0; g < groups; g++) {
+        int begin = base + g * MULTIRATE_GROUP;
+        int end = begin + MULTIRATE_GROUP < base + n ? begin + MULTIRATE_GROUP : base + n;
+        float fastest, soonest;
+        multirate_group_scan(ps, begin, end, &fastest, &soonest);
+        
+        if (soonest > 0.0f) {
+            multirate_coast(ps, begin, end);
+            level[g] = -1;
+            continue;
+        }
+        
+        // Fresh particles (-1) have no speed yet and start at the base rate
+        int l = 0;
+        if (soonest == 0.0f) {
+            while (l < job->multirate_levels && fastest < job->multirate_speed[l + 1]) l++;
+        }
+        unsigned int phase = ps->frame + (unsigned int)(begin / MULTIRATE_GROUP);
+        while (l > 0 && (phase & ((1u << l) - 1)) != 0) l--;
+        level[g] = l;
+    }
+    
+    // Integrate runs of due groups at the same level in place
+    for (int g = 0; g < groups;) {
+        if (level[g] < 0) {
+            g++;
+            continue;
+        }
+        int run = g + 1;
+        while (run < groups && level[run] == level[g]) run++;
+        
+        int begin = base + g * MULTIRATE_GROUP;
+        int end = base + run * MULTIRATE_GROUP < base + n ? base + run * MULTIRATE_GROUP : base + n;
+        int interval = 1 << level[g];
+        
+        memcpy(ps->prev_x + begin, ps->x + begin, sizeof(float) * (end - begin));
+        memcpy(ps->prev_y + begin, ps->y + begin, sizeof(float) * (end - begin));
+        
+        IntegratorParams params = job->integrator;
+        params.dt *= (float)interval;
+        integrator_advance_batch(&params, &job->field, ps->x + begin, ps->y + begin,
+                                 ps->speed + begin, ps->step + begin, end - begin);
+        
+        if (interval > 1) {
+            float inv_interval = 1.0f / (float)interval;
+            for (int i = begin; i < end; i++) {
+                ps->x[i] = ps->prev_x[i] + (ps->x[i] - ps->prev_x[i]) * inv_interval;
+                ps->y[i] = ps->prev_y[i] + (ps->y[i] - ps->prev_y[i]) * inv_interval;
+            }
+        }
+        vf left = vf_set1((float)(interval - 1));
+        int full = begin + SIMD_FLOOR(end - begin);
+        for (int i = begin; i < full; i += SIMD_WIDTH) vf_store(ps->coast + i, left);
+        for (int i = full; i < end; i++) ps->coast[i] = (float)(interval - 1);
+        g = run;
+    }
+}
+
+// Integrate, recycle and respawn particles [begin, end), and count where
+// they end up into this worker's occupancy histogram
+static void update_chunk(void* ctx, int begin, int end, int worker) {
+    UpdateJob* job = (UpdateJob*)ctx;
+    ParticleSystem* ps = job->ps;
+    const Config* config = job->config;
+    const ViewCache* cache = &job->cache;
+    const OccupancyGrid* grid = &ps->occupancy;
+    int* counts = grid->counts + (size_t)worker * OCCUPANCY_CELLS;
+    float dt = job->integrator.dt;
+    int changes = 0;
+    int last_cell = -1;
+    
+    // Recycle test, one uniform per particle
+    float recycle_u[PARTICLE_BATCH];
+    int32_t cell[PARTICLE_BATCH];
+    
+    float* restrict px = ps->x;
+    float* restrict py = ps->y;
+    float* restrict prev_x = ps->prev_x;
+    float* restrict prev_y = ps->prev_y;
+    float* restrict lifetime = ps->lifetime;
+    
+    // Process particles in batches
+    for (int base = begin; base < end; base += PARTICLE_BATCH) {
+        int n = end - base;
+        if (n > PARTICLE_BATCH) n = PARTICLE_BATCH;
+        
+        if (job->multirate_levels > 0) {
+            advance_multirate(job, base, n);
+        } else {
+            // Save previous position BEFORE integration
+            memcpy(prev_x + base, px + base, sizeof(float) * n);
+            memcpy(prev_y + base, py + base, sizeof(float) * n);
             
-            // Jittered grid: add random offset from cell center
-            float jitter_x = (randf() - 0.5f) * step_x * 0.8f;
-            float jitter_y = (randf() - 0.5f) * step_y * 0.8f;
+            if (job->flow_map) {
+                field_cache_advance(job->flow_map, px + base, py + base, ps->speed + base, n);
+            } else {
+                integrator_advance_batch(&job->integrator, &job->field, px + base, py + base,
+                                         ps->speed + base, ps->step + base, n);
+            }
+        }
+        rng_uniform_batch(ps->seed, base, n, ps->frame, RNG_STREAM_RECYCLE, recycle_u);
+        occupancy_cells(job, px + base, py + base, n, cell);
+        
+        for (int i = base; i < base + n; i++) {
+            lifetime[i] += dt;
             
-            ps->particles[idx].position.x = cache.left + (i + 0.5f) * step_x + jitter_x;
-            ps->particles[idx].position.y = cache.bottom + (j + 0.5f) * step_y + jitter_y;
-            ps->particles[idx].prev_position = ps->particles[idx].position;
-            ps->particles[idx].lifetime = randf() * lifetime_mult;
+            // Check if particle needs respawning
+            bool outside = is_particle_outside_view(px[i], py[i], cache);
+            bool expired = lifetime[i] > config->particle_lifetime;
             
-            idx++;
+            // Particles piling up in attracting regions are moved to sparse ones
+            bool crowded = recycle_u[i - base] < grid->recycle[cell[i - base]];
+            
+            if (outside || expired || crowded) {
+                float u[4];
+                rng_uniform4(ps->seed, i, ps->frame, RNG_STREAM_RESPAWN, u);
+                
+                occupancy_sample(grid, cache, u, &px[i], &py[i]);
+                cell[i - base] = occupancy_cell(px[i], py[i], cache, job->cells_per_x, job->cells_per_y);
+                prev_x[i] = px[i];
+                prev_y[i] = py[i];
+                
+                // Random lifetime to prevent synchronization
+                lifetime[i] = u[3] * config->particle_lifetime * 0.2f;
+                ps->step[i] = 0.0f;
+                ps->coast[i] = -1.0f;
+                particle_mark_spawn(ps, i, px[i], py[i]);
+            }
+            
+            counts[cell[i - base]]++;
+            
+            // Only neighbors within an aligned group count, so the total
+            // doesn't depend on where the pool splits the chunks
+            changes += (i & (THREAD_POOL_CHUNK_ALIGN - 1)) != 0 && cell[i - base] != last_cell;
+            last_cell = cell[i - base];
         }
+        
+        // The batch is final; write its vertices while it is in cache
+        if (job->emitter) job->emitter->emit(job->emitter->ctx, ps, base, base + n);
     }
     
-    // Fill remaining particles with pure random distribution
-    while (idx < ps->count) {
-        ps->particles[idx].position.x = randf_range(cache.left, cache.right);
-        ps->particles[idx].position.y = randf_range(cache.bottom, cache.top);
-        ps->particles[idx].prev_position = ps->particles[idx].position;
-        ps->particles[idx].lifetime = randf() * lifetime_mult;
-        idx++;
-    }
+    grid->changes[worker * OCCUPANCY_WORKER_STRIDE] += changes;
 }
 
 // Main update with adaptive integration
 void particle_system_update(ParticleSystem* ps, const Config* config, const Camera* cam, float dt) {
+    particle_system_update_emit(ps, config, cam, dt, NULL);
+}
+
+void particle_system_update_emit(ParticleSystem* ps, const Config* config, const Camera* cam, float dt,
+                                 const ParticleEmitter* emitter) {
     if (!ps || config->paused) return;
     
+    UpdateJob job;
+    job.ps = ps;
+    job.config = config;
+    job.emitter = emitter;
+    
     // Build view cache once for entire frame
-    ViewCache cache;
-    build_view_cache(&cache, cam);
+    build_view_cache(&job.cache, cam);
+    job.cells_per_x = OCCUPANCY_GRID_X / job.cache.view_width;
+    job.cells_per_y = OCCUPANCY_GRID_Y / job.cache.view_height;
+    
+    // Resolve the active field once for entire frame
+    job.field = vector_field_resolve(config);
+    float world_per_pixel = job.cache.view_width / (float)config->window_width;
     
     float adaptive_step = config->integration_step / cam->zoom;
-    float adjusted_dt = dt * config->simulation_speed * adaptive_step;
+    job.integrator.type = config->integrator;
+    job.integrator.dt = dt * config->simulation_speed * adaptive_step;
+    job.flow_map = NULL;
     
-    // CRITICAL: Calculate particles per unit area for UNIFORM density
-    float area = cache.view_width * cache.view_height;
-    float desired_density = ps->count / area;  // particles per square unit
+    // Cached evaluation: cover the view and its respawn margin with tiles
+    float left = job.cache.left - job.cache.margin_x;
+    float right = job.cache.right + job.cache.margin_x;
+    float bottom = job.cache.bottom - job.cache.margin_y;
+    float top = job.cache.top + job.cache.margin_y;
     
-    int forced_respawns_per_frame = (int)(ps->count * 0.005f);  // 0.5% per frame
-    if (forced_respawns_per_frame < 1) forced_respawns_per_frame = 1;
+    if (config->flow_map) {
+        // One RK4 step of the frame's dt per sample, on the fused loop if any
+        Config rk4 = *config;
+        rk4.integrator = INTEGRATOR_RK4;
+        rk4.field_cache = FIELD_CACHE_OFF;
+        IntegratorParams flow = {INTEGRATOR_RK4, job.integrator.dt, 0.0f, 1, integrator_resolve_fused(&rk4)};
+        
+        if (!ps->flow_map) ps->flow_map = field_cache_create(ps->pool);
+        if (ps->flow_map) {
+            field_cache_prepare_flow(ps->flow_map, config, &job.field, &flow,
+                                     left, right, bottom, top, world_per_pixel);
+            job.flow_map = ps->flow_map;
+        }
+    } else if (config->field_cache != FIELD_CACHE_OFF) {
+        if (!ps->field_cache) ps->field_cache = field_cache_create(ps->pool);
+        if (ps->field_cache) {
+            field_cache_prepare(ps->field_cache, config, &job.field, left, right, bottom, top, world_per_pixel);
+            job.field.cache = ps->field_cache;
+        }
+    }
     
-    int respawn_counter = 0;
+    // RK45 tolerance is given in pixels; convert to world units
+    job.integrator.tolerance = config->integration_tolerance * world_per_pixel;
+    job.integrator.max_steps = config->integration_max_steps;
+    job.integrator.fused = integrator_resolve_fused(config);
     
-    // Process all particles
-    for (int i = 0; i < ps->count; i++) {
-        Particle* p = &ps->particles[i];
-        
-        // Save previous position BEFORE integration
-        p->prev_position = p->position;
-        
-        // Evaluate vector field
-        vec2 velocity = vector_field_evaluate(p->position, config);
-        update_particle_color(p, velocity);
-        
-        // RK4 Integration
-        float x0 = p->position.x;
-        float y0 = p->position.y;
-        
-        vec2 k1 = velocity;
-        float dt_half = adjusted_dt * 0.5f;
-        
-        vec2 pos2 = {x0 + k1.x * dt_half, y0 + k1.y * dt_half};
-        vec2 k2 = vector_field_evaluate(pos2, config);
-        
-        vec2 pos3 = {x0 + k2.x * dt_half, y0 + k2.y * dt_half};
-        vec2 k3 = vector_field_evaluate(pos3, config);
-        
-        vec2 pos4 = {x0 + k3.x * adjusted_dt, y0 + k3.y * adjusted_dt};
-        vec2 k4 = vector_field_evaluate(pos4, config);
-        
-        float dt_sixth = adjusted_dt * 0.16666667f;
-        p->position.x = x0 + (k1.x + 2.0f*k2.x + 2.0f*k3.x + k4.x) * dt_sixth;
-        p->position.y = y0 + (k1.y + 2.0f*k2.y + 2.0f*k3.y + k4.y) * dt_sixth;
-        
-        p->lifetime += adjusted_dt;
+    // Multirate levels allowed by the configured interval, and the speed
+    // limit of each: a level's step may cover at most multirate_pixels.
+    // Flow map tiles hold a single dt, so they always step every frame.
+    job.multirate_levels = 0;
+    while (job.multirate_levels + 1 < MULTIRATE_LEVELS &&
+           (2 << job.multirate_levels) <= config->multirate_interval) {
+        job.multirate_levels++;
+    }
+    if (job.flow_map) job.multirate_levels = 0;
+    for (int level = 0; level < MULTIRATE_LEVELS; level++) {
+        // speed = |v|^2 / 4 (see particle_speed), capped at 1
+        float max_velocity = config->multirate_pixels * world_per_pixel /
+                             ((float)(1 << level) * fabsf(job.integrator.dt));
+        job.multirate_speed[level] = fminf(max_velocity * max_velocity * 0.25f, 1.0f);
+    }
+    
+    // Integration and respawn run on the pool, one aligned chunk per task
+    thread_pool_run(ps->pool, ps->count, PARTICLE_MIN_CHUNK, update_chunk, &job);
+    occupancy_rebuild(&ps->occupancy);
+    
+    // Re-sort periodically, or early once respawns and drift have scattered
+    // neighbors in memory across the view. Only the field cache and the flow
+    // map read memory by position; without them the order can't pay for the
+    // sort (make bench-sort).
+    bool indexed = job.flow_map || job.field.cache;
+    unsigned int since_sort = ps->frame - ps->sort.last_frame;
+    if (config->sort_interval > 0 && indexed &&
+        (since_sort >= (unsigned int)config->sort_interval ||
+         (since_sort >= SORT_MIN_SPACING && ps->occupancy.disorder > config->sort_disorder))) {
+        particle_system_sort(ps, cam);
+    }
+    ps->frame++;
+}
+
+// =============================================================================
+// Spatial Sorting
+// =============================================================================
+
+// Morton key: 8 bits per axis (256 x 256 cells over the view), sorted with
+// two 8-bit LSD radix passes
+#define SORT_AXIS_BITS 8
+#define SORT_RADIX_BITS 8
+#define SORT_RADIX (1 << SORT_RADIX_BITS)
+#define SORT_PASSES (2 * SORT_AXIS_BITS / SORT_RADIX_BITS)
+
+// Particles per radix block. Blocks are the unit of parallel work and each
+// keeps its own digit histogram, so the sort is stable for any thread count.
+#define SORT_BLOCK 2048
+
+typedef struct {
+    ParticleSystem* ps;
+    ViewCache cache;
+    float cells_per_x, cells_per_y;  // Key cells per world unit
+    int shift;                       // Digit of the current radix pass
+    int src;                         // keys/order buffer read by the current pass
+    float* gather;                   // Particle array permuted by the current gather
+} SortJob;
+
+// Spread the low 8 bits of v to the even bits
+static inline uint32_t morton_spread(uint32_t v) {
+    v = (v | (v << 4)) & 0x0F0Fu;
+    v = (v | (v << 2)) & 0x3333u;
+    v = (v | (v << 1)) & 0x5555u;
+    return v;
+}
+
+static void particle_sort_free(ParticleSort* sort) {
+    for (int k = 0; k < 2; k++) {
+        free(sort->keys[k]);
+        free(sort->order[k]);
+        sort->keys[k] = NULL;
+        sort->order[k] = NULL;
+    }
+    free(sort->scratch);
+    free(sort->histograms);
+    sort->scratch = NULL;
+    sort->histograms = NULL;
+    sort->capacity = 0;
+}
+
+// Grow the scratch buffers to the particle capacity
+static bool particle_sort_reserve(ParticleSort* sort, int capacity) {
+    if (sort->capacity >= capacity) return true;
+    
+    particle_sort_free(sort);
+    int blocks = (capacity + SORT_BLOCK - 1) / SORT_BLOCK;
+    bool allocated = true;
+    for (int k = 0; k < 2; k++) {
+        sort->keys[k] = (uint32_t*)malloc(sizeof(uint32_t) * capacity);
+        sort->order[k] = (int32_t*)malloc(sizeof(int32_t) * capacity);
+        allocated = allocated && sort->keys[k] && sort->order[k];
+    }
+    sort->scratch = particle_array_alloc(capacity);
+    sort->histograms = (int*)malloc(sizeof(int) * SORT_RADIX * blocks);
+    
+    if (!allocated || !sort->scratch || !sort->histograms) {
+        particle_sort_free(sort);
+        fprintf(stderr, "Error: Failed to allocate particle sort buffers\n");
+        return false;
+    }
+    sort->capacity = capacity;
+    return true;
+}
+
+// Morton keys of particles [begin, end), identity order
+static void sort_keys_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const SortJob* job = (const SortJob*)ctx;
+    const ParticleSystem* ps = job->ps;
+    const ViewCache* cache = &job->cache;
+    uint32_t* keys = ps->sort.keys[0];
+    int32_t* order = ps->sort.order[0];
+    const int last = (1 << SORT_AXIS_BITS) - 1;
+    
+    for (int i = begin; i < end; i++) {
+        int cx = (int)((ps->x[i] - cache->left) * job->cells_per_x);
+        int cy = (int)((ps->y[i] - cache->bottom) * job->cells_per_y);
+        cx = cx < 0 ? 0 : (cx > last ? last : cx);
+        cy = cy < 0 ? 0 : (cy > last ? last : cy);
+        keys[i] = morton_spread((uint32_t)cx) | (morton_spread((uint32_t)cy) << 1);
+        order[i] = i;
+    }
+}
+
+// Digit histogram of blocks [begin, end)
+static void sort_histogram_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const SortJob* job = (const SortJob*)ctx;
+    const ParticleSort* sort = &job->ps->sort;
+    const uint32_t* keys = sort->keys[job->src];
+    int count = job->ps->count;
+    
+    for (int b = begin; b < end; b++) {
+        int* histogram = sort->histograms + b * SORT_RADIX;
+        memset(histogram, 0, sizeof(int) * SORT_RADIX);
         
-        // Check if particle needs respawning
-        bool outside = is_particle_outside_view(p, &cache);
-        bool expired = p->lifetime > config->particle_lifetime;
+        int last = (b + 1) * SORT_BLOCK < count ? (b + 1) * SORT_BLOCK : count;
+        for (int i = b * SORT_BLOCK; i < last; i++) {
+            histogram[(keys[i] >> job->shift) & (SORT_RADIX - 1)]++;
+        }
+    }
+}
+
+// Scatter blocks [begin, end) to their digit offsets (histograms hold the
+// exclusive prefix sums by now)
+static void sort_scatter_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const SortJob* job = (const SortJob*)ctx;
+    const ParticleSort* sort = &job->ps->sort;
+    const uint32_t* restrict src_keys = sort->keys[job->src];
+    const int32_t* restrict src_order = sort->order[job->src];
+    uint32_t* restrict dst_keys = sort->keys[job->src ^ 1];
+    int32_t* restrict dst_order = sort->order[job->src ^ 1];
+    int count = job->ps->count;
+    
+    for (int b = begin; b < end; b++) {
+        int* offset = sort->histograms + b * SORT_RADIX;
         
-        // CRITICAL: Force continuous uniform respawning
-        // This prevents clustering in stable flow regions
-        bool force_respawn = (respawn_counter < forced_respawns_per_frame) && 
-                             (randf() < 0.01f);
+        int last = (b + 1) * SORT_BLOCK < count ? (b + 1) * SORT_BLOCK : count;
+        for (int i = b * SORT_BLOCK; i < last; i++) {
+            int j = offset[(src_keys[i] >> job->shift) & (SORT_RADIX - 1)]++;
+            dst_keys[j] = src_keys[i];
+            dst_order[j] = src_order[i];
+        }
+    }
+}
+
+// scratch[i] = array[order[i]] for i in [begin, end)
+static void sort_gather_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const SortJob* job = (const SortJob*)ctx;
+    const int32_t* restrict order = job->ps->sort.order[job->src];
+    const float* restrict src = job->gather;
+    float* restrict dst = job->ps->sort.scratch;
+    
+    for (int i = begin; i < end; i++) {
+        dst[i] = src[order[i]];
+    }
+}
+
+// Reorder every particle array by Morton (Z-order) key of position, so
+// particles close in memory are close in the view. Parallel LSD radix sort
+// of (key, index) pairs, then one gather per array.
+void particle_system_sort(ParticleSystem* ps, const Camera* cam) {
+    if (!ps || ps->count < 2) return;
+    if (!particle_sort_reserve(&ps->sort, ps->capacity)) return;
+    
+    SortJob job;
+    job.ps = ps;
+    build_view_cache(&job.cache, cam);
+    job.cells_per_x = (1 << SORT_AXIS_BITS) / job.cache.view_width;
+    job.cells_per_y = (1 << SORT_AXIS_BITS) / job.cache.view_height;
+    job.src = 0;
+    
+    thread_pool_run(ps->pool, ps->count, PARTICLE_MIN_CHUNK, sort_keys_chunk, &job);
+    
+    int blocks = (ps->count + SORT_BLOCK - 1) / SORT_BLOCK;
+    for (int pass = 0; pass < SORT_PASSES; pass++) {
+        job.shift = pass * SORT_RADIX_BITS;
+        thread_pool_run(ps->pool, blocks, 1, sort_histogram_chunk, &job);
         
-        if (outside || expired || force_respawn) {
-            p->position.x = cache.left + randf() * cache.view_width;
-            p->position.y = cache.bottom + randf() * cache.view_height;
-            p->prev_position = p->position;
-            
-            // Random lifetime to prevent synchronization
-            p->lifetime = randf() * config->particle_lifetime * 0.2f;
-            
-            if (force_respawn) respawn_counter++;
+        // Exclusive prefix sum in (digit, block) order keeps the pass stable
+        int sum = 0;
+        for (int d = 0; d < SORT_RADIX; d++) {
+            for (int b = 0; b < blocks; b++) {
+                int* h = ps->sort.histograms + b * SORT_RADIX + d;
+                int n = *h;
+                *h = sum;
+                sum += n;
+            }
         }
+        
+        thread_pool_run(ps->pool, blocks, 1, sort_scatter_chunk, &job);
+        job.src ^= 1;
     }
+    
+    // Permute the arrays through one scratch array, swapping it in each time
+#define X(name) \
+    job.gather = ps->name; \
+    thread_pool_run(ps->pool, ps->count, PARTICLE_MIN_CHUNK, sort_gather_chunk, &job); \
+    ps->name = ps->sort.scratch; \
+    ps->sort.scratch = job.gather;
+    PARTICLE_ARRAYS(X)
+#undef X
+    
+    ps->sort.last_frame = ps->frame;
 }
 
 // Calculate target particle count based on visible area
@@ -258,7 +966,7 @@ void particle_system_adjust_count_for_zoom(ParticleSystem* ps, const Config* con
     
     // Clamp to reasonable bounds
     if (target < 1000) target = 1000;
-    if (target > 200000) target = 200000;
+    if (target > PARTICLE_MAX_COUNT) target = PARTICLE_MAX_COUNT;
     
     ps->target_count = target;
     
@@ -274,7 +982,12 @@ void particle_system_adjust_count_for_zoom(ParticleSystem* ps, const Config* con
 
 void particle_system_destroy(ParticleSystem* ps) {
     if (ps) {
-        if (ps->particles) free(ps->particles);
+        particle_arrays_free(ps);
+        free(ps->occupancy.counts);
+        free(ps->occupancy.changes);
+        particle_sort_free(&ps->sort);
+        field_cache_destroy(ps->field_cache);
+        field_cache_destroy(ps->flow_map);
         free(ps);
     }
 }
\ No newline at end of file
@@ -4,25 +4,104 @@
 #include "config.h"
 #include "vector_field.h"
 #include "camera.h"
+#include "thread_pool.h"
+#include "field_cache.h"
 #include <stdbool.h>
+#include <stdint.h>
 
-// Single particle data
+// Per-particle arrays of the structure-of-arrays layout. Every array holds
+// `capacity` floats; the list drives allocation, resizing and freeing.
+#define PARTICLE_ARRAYS(X) \
+    X(x)                   \
+    X(y)                   \
+    X(prev_x)              \
+    X(prev_y)              \
+    X(lifetime)            \
+    X(speed)               \
+    X(step)                \
+    X(coast)               \
+    X(trail_slot)          \
+    X(generation)          \
+    X(frame_x)             \
+    X(frame_y)
+
+// ParticleSystem.generation counts (re)spawns modulo this
+#define PARTICLE_GENERATIONS 65536
+
+// Alignment of every particle array (one cache line)
+#define PARTICLE_ALIGNMENT 64
+
+// Coarse occupancy histogram over the view, rebuilt during every update
+#define OCCUPANCY_GRID_X 32
+#define OCCUPANCY_GRID_Y 32
+#define OCCUPANCY_CELLS (OCCUPANCY_GRID_X * OCCUPANCY_GRID_Y)
+
+// Density control: respawns are drawn from an alias table that favors
+// under-populated cells, and particles in crowded cells are recycled
+typedef struct {
+    int* counts;          // [worker][cell] partial histograms, one row per pool worker
+    int workers;
+    float prob[OCCUPANCY_CELLS];     // Alias table: keep probability of each column
+    int alias[OCCUPANCY_CELLS];      // Alias table: fallback cell of each column
+    float recycle[OCCUPANCY_CELLS];  // Per-frame recycle probability of a particle in the cell
+    int* changes;         // [worker * OCCUPANCY_WORKER_STRIDE] neighbors in memory in different cells
+    float disorder;       // Fraction of particles in a different cell than their predecessor
+    bool valid;           // False until the first histogram (spawn uniformly)
+} OccupancyGrid;
+
+// Spacing of per-worker counters (one cache line)
+#define OCCUPANCY_WORKER_STRIDE 16
+
+// Scratch space of particle_system_sort, grown with the particle arrays
 typedef struct {
-    vec2 position;       // Current position in world space
-    vec2 prev_position;  // Previous position (for trail rendering)
-    vec2 velocity;       // Current velocity (not actively used, can be removed if unused)
-    float color[4];      // RGBA color (computed from velocity magnitude)
-    float lifetime;      // Current age of particle (seconds)
-} Particle;
-
-// Dynamic particle system
+    uint32_t* keys[2];    // Morton keys, ping-pong between radix passes
+    int32_t* order[2];    // Source index of each sorted slot
+    float* scratch;       // Gather target, swapped with each particle array in turn
+    int* histograms;      // [block][digit] counts of one radix pass
+    int capacity;
+    unsigned int last_frame;  // Frame of the last sort
+} ParticleSort;
+
+// Dynamic particle system (structure of arrays)
 typedef struct {
-    Particle* particles;  // Dynamic array of particles
+    float* x;            // Current position X in world space
+    float* y;            // Current position Y in world space
+    float* prev_x;       // Previous position X (for trail rendering)
+    float* prev_y;       // Previous position Y (for trail rendering)
+    float* lifetime;     // Current age of particle (seconds)
+    float* speed;        // Normalized speed 0-1 (drives color)
+    float* step;         // RK45 step size carried across frames (0 = unset)
+    float* coast;        // Multirate: frames left to repeat the last displacement
+                         // (0 = integrate now, -1 = integrate now at the base rate)
+    float* trail_slot;   // Column of the particle's trail history (an exact integer).
+                         // Moves with the particle when sorted; the live columns are
+                         // always a permutation of [0, count).
+    float* generation;   // Spawn count of the particle (an exact integer, modulo
+                         // PARTICLE_GENERATIONS): changes whenever it is (re)spawned,
+                         // so its trail restarts instead of jumping
+    float* frame_x;      // Render position X of the last frame, where this frame's
+    float* frame_y;      // segment starts (the renderer's emitters advance it)
     int count;           // Current number of active particles
     int capacity;        // Allocated capacity (may be > count)
     int target_count;    // Target count based on zoom level
+    ThreadPool* pool;    // Shared worker pool (NULL = single-threaded)
+    unsigned int seed;   // RNG key (see rng.h)
+    unsigned int frame;  // Update counter, part of the RNG counter
+    OccupancyGrid occupancy;
+    ParticleSort sort;
+    FieldCache* field_cache;  // Created on first use (NULL = exact evaluation)
+    FieldCache* flow_map;     // Created on first use of the flow map mode
 } ParticleSystem;
 
+// Consumer of finished particles, called by every update worker for each
+// batch of its chunk as soon as the batch is final (fused vertex emission).
+// It advances frame_x/frame_y of the batch (and nothing else), so each
+// frame emits once.
+typedef struct {
+    void (*emit)(void* ctx, ParticleSystem* ps, int begin, int end);
+    void* ctx;
+} ParticleEmitter;
+
 // View cache
 typedef struct {
     float left, right, bottom, top;
@@ -30,12 +109,17 @@ typedef struct {
     float margin_x, margin_y;
 } ViewCache;
 
-ParticleSystem* particle_system_create(int initial_capacity);
+ParticleSystem* particle_system_create(int initial_capacity, unsigned int seed, ThreadPool* pool);
 void particle_system_init_particles(ParticleSystem* ps, const Config* config, const Camera* cam);
 void particle_system_resize(ParticleSystem* ps, int new_count);
 void particle_system_redistribute(ParticleSystem* ps, const Config* config, const Camera* cam);
 void particle_system_redistribute_grid(ParticleSystem* ps, const Config* config, const Camera* cam);
 void particle_system_update(ParticleSystem* ps, const Config* config, const Camera* cam, float dt);
+// Same, handing each finished batch to the emitter (NULL = none). A paused
+// system emits nothing.
+void particle_system_update_emit(ParticleSystem* ps, const Config* config, const Camera* cam, float dt,
+                                 const ParticleEmitter* emitter);
+void particle_system_sort(ParticleSystem* ps, const Camera* cam);
 void particle_system_adjust_count_for_zoom(ParticleSystem* ps, const Config* config, const Camera* cam);
 void particle_system_reset(ParticleSystem* ps, const Config* config, const Camera* cam);
 void particle_system_destroy(ParticleSystem* ps);
@@ -1,4 +1,6 @@
+#define GL_GLEXT_PROTOTYPES  // glBufferStorage, glFenceSync, ... from glext.h
 #include "renderer.h"
+#include "soft_renderer.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -17,7 +19,405 @@ static void check_gl_error(const char* operation) {
 #endif
 }
 
-Renderer* renderer_create() {
+// Normalized short of v, clamped to [-1, 1] and rounded to nearest
+static inline int16_t vertex_snorm(float v) {
+    v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+    // Adding 1.5 * 2^23 leaves no fraction bits, so the sum rounds
+    return (int16_t)((v * 32767.0f + 12582912.0f) - 12582912.0f);
+}
+
+// Particles per vertex build task
+#define VERTEX_MIN_CHUNK 4096
+
+// Render position of particle i at the emit's alpha. It becomes the
+// particle's frame position: the segment drawn next frame starts there.
+static inline void advance_frame_position(const ParticleEmit* emit, ParticleSystem* ps, int i,
+                                          float* x, float* y) {
+    *x = ps->prev_x[i] + (ps->x[i] - ps->prev_x[i]) * emit->alpha;
+    *y = ps->prev_y[i] + (ps->y[i] - ps->prev_y[i]) * emit->alpha;
+    ps->frame_x[i] = *x;
+    ps->frame_y[i] = *y;
+}
+
+// Write line vertices for particles [begin, end). Each line is the path
+// covered since the last frame, from the frame position to the interpolated
+// render position, so every frame rate lays down the same trail.
+static void emit_vertices(const ParticleEmit* emit, ParticleSystem* ps, int begin, int end) {
+    ParticleVertex* vertices = (ParticleVertex*)emit->target;
+    int16_t tail_alpha = vertex_snorm(PARTICLE_ALPHA * 0.5f);
+    int16_t head_alpha = vertex_snorm(PARTICLE_ALPHA);
+    
+    for (int i = begin; i < end; i++) {
+        int idx = i * 2;
+        int16_t speed = vertex_snorm(ps->speed[i]);
+        float tail_x = (ps->frame_x[i] - emit->center_x) * emit->scale_x;
+        float tail_y = (ps->frame_y[i] - emit->center_y) * emit->scale_y;
+        float head_x, head_y;
+        advance_frame_position(emit, ps, i, &head_x, &head_y);
+        
+        // Start vertex (last frame's render position)
+        vertices[idx].position[0] = vertex_snorm(tail_x);
+        vertices[idx].position[1] = vertex_snorm(tail_y);
+        vertices[idx].speed = speed;
+        vertices[idx].alpha = tail_alpha;
+        
+        // End vertex (render position)
+        vertices[idx + 1].position[0] = vertex_snorm((head_x - emit->center_x) * emit->scale_x);
+        vertices[idx + 1].position[1] = vertex_snorm((head_y - emit->center_y) * emit->scale_y);
+        vertices[idx + 1].speed = speed;
+        vertices[idx + 1].alpha = head_alpha;
+    }
+}
+
+// Same segments as emit_vertices, one instance per particle
+static void emit_instances(const ParticleEmit* emit, ParticleSystem* ps, int begin, int end) {
+    ParticleInstance* instances = (ParticleInstance*)emit->target;
+    
+    for (int i = begin; i < end; i++) {
+        float tail_x = (ps->frame_x[i] - emit->center_x) * emit->scale_x;
+        float tail_y = (ps->frame_y[i] - emit->center_y) * emit->scale_y;
+        float head_x, head_y;
+        advance_frame_position(emit, ps, i, &head_x, &head_y);
+        
+        instances[i].segment[0] = vertex_snorm(tail_x);
+        instances[i].segment[1] = vertex_snorm(tail_y);
+        instances[i].segment[2] = vertex_snorm((head_x - emit->center_x) * emit->scale_x);
+        instances[i].segment[3] = vertex_snorm((head_y - emit->center_y) * emit->scale_y);
+        instances[i].speed = vertex_snorm(ps->speed[i]);
+        instances[i].padding = 0;
+    }
+}
+
+// ParticleEmitter callback: particles [begin, end) own records [begin, end)
+// of the frame and their frame positions, so workers write disjoint ranges
+static void emit_particles(void* ctx, ParticleSystem* ps, int begin, int end) {
+    const ParticleEmit* emit = (const ParticleEmit*)ctx;
+    if (emit->mode == RENDER_QUADS) {
+        emit_instances(emit, ps, begin, end);
+    } else {
+        emit_vertices(emit, ps, begin, end);
+    }
+}
+
+typedef struct {
+    ParticleSystem* ps;
+    ParticleEmit* emit;
+} VertexBuildJob;
+
+// Separate pass over the particles (no fused update)
+static void build_vertices_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const VertexBuildJob* job = (const VertexBuildJob*)ctx;
+    emit_particles(job->emit, job->ps, begin, end);
+}
+
+// Longest wait for a ring region before checking again (nanoseconds)
+#define RING_WAIT_TIMEOUT 100000000ull
+
+// True if the current context supports an extension (GL 3.0+ query)
+static bool gl_has_extension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension && strcmp(extension, name) == 0) return true;
+    }
+    return false;
+}
+
+// Point the VAO of the current mode at the current frame's records. The
+// offset goes into the attribute pointers rather than the draw's first
+// vertex, since instanced draws only start past instance 0 with base
+// instances (GL 4.2).
+static void ring_bind_frame(const Renderer* renderer) {
+    const void* base = (const void*)renderer->frame_offset;
+    glBindBuffer(GL_ARRAY_BUFFER, renderer->records ? renderer->records : renderer->ring.buffer);
+    
+    if (renderer->mode == RENDER_QUADS) {
+        // Segment (location = 0) and speed (location = 1), advanced per instance
+        glBindVertexArray(renderer->instance_vao);
+        glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, sizeof(ParticleInstance),
+                              (const char*)base + offsetof(ParticleInstance, segment));
+        glVertexAttribDivisor(0, 1);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 1, GL_SHORT, GL_TRUE, sizeof(ParticleInstance),
+                              (const char*)base + offsetof(ParticleInstance, speed));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(1);
+    } else {
+        // Position, speed and alpha in one attribute (location = 0)
+        glBindVertexArray(renderer->vao);
+        glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, sizeof(ParticleVertex), base);
+        glEnableVertexAttribArray(0);
+    }
+    
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Block until the GPU is done with a region
+static void ring_wait(VertexRing* ring, int region) {
+    GLsync fence = ring->fences[region];
+    if (!fence) return;
+    
+    GLenum status;
+    do {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, RING_WAIT_TIMEOUT);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    
+    glDeleteSync(fence);
+    ring->fences[region] = NULL;
+}
+
+static void ring_release(VertexRing* ring) {
+    for (int r = 0; r < RENDERER_RING_FRAMES; r++) {
+        if (ring->fences[r]) glDeleteSync(ring->fences[r]);
+        ring->fences[r] = NULL;
+    }
+    if (ring->buffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, ring->buffer);
+        if (ring->mapped) glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDeleteBuffers(1, &ring->buffer);
+    }
+    ring->buffer = 0;
+    ring->mapped = NULL;
+    ring->region_size = 0;
+}
+
+// (Re)create the ring with room for `bytes` per region. Immutable
+// storage is mapped once, coherently, for the ring's lifetime; without
+// GL_ARB_buffer_storage each frame maps its region unsynchronized.
+static bool ring_reserve(Renderer* renderer, size_t bytes) {
+    VertexRing* ring = &renderer->ring;
+    if (bytes <= ring->region_size) return true;
+    
+    // Same growth as the particle arrays, keeping regions aligned for any record
+    size_t region_size = (bytes + bytes / 2 + 15) & ~(size_t)15;
+    GLsizeiptr size = (GLsizeiptr)(region_size * RENDERER_RING_FRAMES);
+    
+    // Draws still queued keep the old buffer alive until they are done
+    ring_release(ring);
+    glGenBuffers(1, &ring->buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, ring->buffer);
+    if (ring->persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+        ring->mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    if (ring->persistent && !ring->mapped) {
+        fprintf(stderr, "Error: Failed to map particle vertex ring\n");
+        ring_release(ring);
+        return false;
+    }
+    
+    ring->region_size = region_size;
+    ring->region = 0;
+    check_gl_error("Vertex ring allocation");
+    return true;
+}
+
+static void trails_release(TrailHistory* trails) {
+    glDeleteTextures(1, &trails->history_texture);
+    glDeleteTextures(1, &trails->state_texture);
+    glDeleteBuffers(1, &trails->history);
+    glDeleteBuffers(1, &trails->state);
+    free(trails->row);
+    free(trails->columns);
+    free(trails->generations);
+    memset(trails, 0, sizeof(*trails));
+}
+
+// Texture buffer over a new buffer of `size` bytes
+static void trails_texture_buffer(unsigned int* buffer, unsigned int* texture, GLenum format, size_t size) {
+    glGenBuffers(1, buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+    glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)size, NULL, GL_DYNAMIC_DRAW);
+    glGenTextures(1, texture);
+    glBindTexture(GL_TEXTURE_BUFFER, *texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+// (Re)create the history with room for `count` columns of `length` rows.
+// Every column starts without positions.
+static bool trails_reserve(TrailHistory* trails, int count, int length) {
+    int capacity = count + count / 2;
+    trails_release(trails);
+    
+    GLint max_texels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+    if ((long long)capacity * length > max_texels) {
+        fprintf(stderr, "Error: Trail history of %d x %d exceeds the texture buffer limit (%d)\n",
+                capacity, length, max_texels);
+        return false;
+    }
+    
+    trails->row = (float*)malloc(sizeof(float) * 2 * (size_t)capacity);
+    trails->columns = (unsigned char*)calloc((size_t)capacity, 2);
+    trails->generations = (float*)malloc(sizeof(float) * (size_t)capacity);
+    if (!trails->row || !trails->columns || !trails->generations) {
+        fprintf(stderr, "Error: Failed to allocate trail history\n");
+        trails_release(trails);
+        return false;
+    }
+    
+    trails_texture_buffer(&trails->history, &trails->history_texture, GL_RG32F,
+                          sizeof(float) * 2 * (size_t)capacity * (size_t)length);
+    trails_texture_buffer(&trails->state, &trails->state_texture, GL_RG8UI, 2 * (size_t)capacity);
+    trails->capacity = capacity;
+    trails->length = length;
+    trails->newest = 0;
+    trails->count = 0;
+    check_gl_error("Trail history allocation");
+    return true;
+}
+
+// Rows of trail history kept for ps (0 = no trails). Trails need the
+// particles on the CPU.
+static int trail_length(const Renderer* renderer, const ParticleSystem* ps, const Config* config) {
+    if (!ps || renderer->records || config->trail_length < 2) return 0;
+    return config->trail_length < RENDERER_MAX_TRAIL ? config->trail_length : RENDERER_MAX_TRAIL;
+}
+
+// Append the particles' positions as the newest row, once per simulation
+// step (ps->frame). Uploads one row and the column state, so the cost
+// doesn't grow with the trail length.
+static void trails_push(TrailHistory* trails, const ParticleSystem* ps, int length) {
+    if (length < 2 || ps->count == 0) {
+        if (trails->length) trails_release(trails);
+        return;
+    }
+    if (length != trails->length || ps->count > trails->capacity) {
+        if (!trails_reserve(trails, ps->count, length)) return;
+    } else if (ps->frame == trails->frame && ps->count == trails->count) {
+        return;
+    }
+    
+    // Shrinking renumbers the columns (see particle_system_resize); growing
+    // adds columns without positions
+    unsigned char* columns = trails->columns;
+    if (ps->count < trails->count) {
+        memset(columns, 0, 2 * (size_t)ps->count);
+    } else {
+        memset(columns + 2 * trails->count, 0, 2 * (size_t)(ps->count - trails->count));
+    }
+    
+    // A particle of a new generation was (re)spawned since the last row:
+    // its trail restarts at the new position
+    float* row = trails->row;
+    float* generations = trails->generations;
+    for (int i = 0; i < ps->count; i++) {
+        int c = (int)ps->trail_slot[i];
+        row[2 * c] = ps->x[i];
+        row[2 * c + 1] = ps->y[i];
+        int valid = columns[2 * c];
+        bool spawned = valid == 0 || generations[c] != ps->generation[i];
+        generations[c] = ps->generation[i];
+        columns[2 * c] = (unsigned char)(spawned ? 1 : (valid < length ? valid + 1 : length));
+        columns[2 * c + 1] = (unsigned char)(ps->speed[i] * 255.0f + 0.5f);
+    }
+    
+    trails->newest = (trails->newest + 1) % length;
+    glBindBuffer(GL_TEXTURE_BUFFER, trails->history);
+    glBufferSubData(GL_TEXTURE_BUFFER,
+                    (GLintptr)(sizeof(float) * 2 * (size_t)trails->newest * (size_t)trails->capacity),
+                    (GLsizeiptr)(sizeof(float) * 2 * (size_t)ps->count), row);
+    glBindBuffer(GL_TEXTURE_BUFFER, trails->state);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)(2 * (size_t)ps->count), columns);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    
+    trails->frame = ps->frame;
+    trails->count = ps->count;
+    check_gl_error("Trail history upload");
+}
+
+// One line strip per column, newest position first, fading with age
+static void trails_draw(const Renderer* renderer, const Camera* cam) {
+    const TrailHistory* trails = &renderer->trails;
+    float left, right, bottom, top;
+    camera_get_view_bounds(cam, &left, &right, &bottom, &top);
+    
+    glUseProgram(renderer->trail_shader.program_id);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, trails->history_texture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, trails->state_texture);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(renderer->trail_colormap_loc, 0);
+    glUniform1i(renderer->trail_history_loc, 1);
+    glUniform1i(renderer->trail_state_loc, 2);
+    glUniform4f(renderer->trail_view_loc, (left + right) * 0.5f, (bottom + top) * 0.5f,
+                2.0f / (right - left), 2.0f / (top - bottom));
+    glUniform3i(renderer->trail_rows_loc, trails->newest, trails->length, trails->capacity);
+    glUniform1f(renderer->trail_alpha_loc, PARTICLE_ALPHA);
+    glUniform1f(renderer->trail_weight_loc, 1.0f);  // Redrawn whole every frame
+    
+    // Positions come from the texture buffers; any VAO will do
+    glBindVertexArray(renderer->vao);
+    glLineWidth(1.0f);
+    glDrawArraysInstanced(GL_LINE_STRIP, 0, trails->length, trails->count);
+    
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    check_gl_error("Draw trails");
+}
+
+static void accumulation_release(Accumulation* accumulation) {
+    glDeleteFramebuffers(2, accumulation->framebuffers);
+    glDeleteTextures(2, accumulation->textures);
+    memset(accumulation, 0, sizeof(*accumulation));
+}
+
+// (Re)create both buffers at width x height, cleared to black
+static bool accumulation_reserve(Accumulation* accumulation, int width, int height) {
+    if (accumulation->textures[0] && accumulation->width == width && accumulation->height == height) {
+        return true;
+    }
+    
+    accumulation_release(accumulation);
+    glGenTextures(2, accumulation->textures);
+    glGenFramebuffers(2, accumulation->framebuffers);
+    
+    bool complete = true;
+    for (int i = 0; i < 2; i++) {
+        // Filtered linearly when scaled up to the window
+        glBindTexture(GL_TEXTURE_2D, accumulation->textures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+        
+        glBindFramebuffer(GL_FRAMEBUFFER, accumulation->framebuffers[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               accumulation->textures[i], 0);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    if (!complete) {
+        fprintf(stderr, "Error: RGBA16F accumulation framebuffer is incomplete\n");
+        accumulation_release(accumulation);
+        return false;
+    }
+    
+    accumulation->width = width;
+    accumulation->height = height;
+    check_gl_error("Accumulation allocation");
+    return true;
+}
+
+Renderer* renderer_create(ThreadPool* pool) {
     Renderer* renderer = (Renderer*)malloc(sizeof(Renderer));
     if (!renderer) {
         fprintf(stderr, "Error: Failed to allocate renderer\n");
@@ -25,15 +425,32 @@ Renderer* renderer_create() {
     }
     
     renderer->vao = 0;
-    renderer->vbo = 0;
+    renderer->instance_vao = 0;
+    memset(&renderer->ring, 0, sizeof(renderer->ring));
+    renderer->frame_offset = 0;
+    renderer->records = 0;
+    renderer->mode = RENDER_LINES;
+    memset(&renderer->emit, 0, sizeof(renderer->emit));
+    memset(&renderer->trails, 0, sizeof(renderer->trails));
+    memset(&renderer->accumulation, 0, sizeof(renderer->accumulation));
     renderer->fade_vao = 0;
     renderer->fade_vbo = 0;
     renderer->particle_shader.program_id = 0;
     renderer->particle_shader.is_valid = false;
+    renderer->quad_shader.program_id = 0;
+    renderer->quad_shader.is_valid = false;
+    renderer->trail_shader.program_id = 0;
+    renderer->trail_shader.is_valid = false;
     renderer->fade_shader.program_id = 0;
     renderer->fade_shader.is_valid = false;
+    renderer->present_shader.program_id = 0;
+    renderer->present_shader.is_valid = false;
     renderer->initialized = false;
     renderer->particle_count = 0;
+    renderer->viewport_width = 1;
+    renderer->viewport_height = 1;
+    renderer->pool = pool;
+    renderer->software = NULL;
     
     return renderer;
 }
@@ -41,26 +458,40 @@ Renderer* renderer_create() {
 bool renderer_init(Renderer* renderer, int window_width, int window_height) {
     if (!renderer) return false;
     
-    // Create particle VAO/VBO
+    // Particle VAOs (lines and instanced quads); their buffer is the vertex
+    // ring, created on first update
     glGenVertexArrays(1, &renderer->vao);
-    glGenBuffers(1, &renderer->vbo);
+    glGenVertexArrays(1, &renderer->instance_vao);
     
-    glBindVertexArray(renderer->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo);
+    // Persistent mapping needs GL 4.4 or GL_ARB_buffer_storage
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    renderer->ring.persistent = major > 4 || (major == 4 && minor >= 4) ||
+                                gl_has_extension("GL_ARB_buffer_storage");
+    printf("Particle vertices: %s ring of %d frames\n",
+           renderer->ring.persistent ? "persistent-mapped" : "map-unsynchronized", RENDERER_RING_FRAMES);
     
-    // Position attribute (location = 0)
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex), (void*)0);
-    glEnableVertexAttribArray(0);
+    check_gl_error("Particle VAO setup");
     
-    // Color attribute (location = 1)
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex), 
-                          (void*)offsetof(ParticleVertex, color));
-    glEnableVertexAttribArray(1);
+    // Speed colormap, linearly filtered between texel centers
+    unsigned char texels[COLORMAP_SIZE][4];
+    for (int t = 0; t < COLORMAP_SIZE; t++) {
+        float color[3];
+        particle_color_from_speed((float)t / (COLORMAP_SIZE - 1), color);
+        for (int c = 0; c < 3; c++) texels[t][c] = (unsigned char)(color[c] * 255.0f + 0.5f);
+        texels[t][3] = 255;
+    }
     
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glGenTextures(1, &renderer->colormap);
+    glBindTexture(GL_TEXTURE_1D, renderer->colormap);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, COLORMAP_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    glBindTexture(GL_TEXTURE_1D, 0);
     
-    check_gl_error("Particle VAO setup");
+    check_gl_error("Colormap setup");
     
     // Create fade quad VAO/VBO (full-screen quad in NDC)
     float fade_vertices[] = {
@@ -86,13 +517,29 @@ bool renderer_init(Renderer* renderer, int window_width, int window_height) {
     check_gl_error("Fade VAO setup");
     
     // Load particle shader
-    renderer->particle_shader = shader_create_program("shaders/particle.vert", "shaders/particle.frag");
+    renderer->particle_shader = shader_create_program("shaders/particle.vert", "shaders/particle_line.frag");
     
     if (!renderer->particle_shader.is_valid) {
         fprintf(stderr, "Error: Failed to create particle shader program\n");
         return false;
     }
     
+    // Load instanced quad shader (same fragment stage)
+    renderer->quad_shader = shader_create_program("shaders/particle_quad.vert", "shaders/particle.frag");
+    
+    if (!renderer->quad_shader.is_valid) {
+        fprintf(stderr, "Error: Failed to create particle quad shader program\n");
+        return false;
+    }
+    
+    // Load trail shader (same fragment stage)
+    renderer->trail_shader = shader_create_program("shaders/trail.vert", "shaders/particle.frag");
+    
+    if (!renderer->trail_shader.is_valid) {
+        fprintf(stderr, "Error: Failed to create trail shader program\n");
+        return false;
+    }
+    
     // Load fade shader
     renderer->fade_shader = shader_create_program("shaders/fade.vert", "shaders/fade.frag");
     
@@ -101,9 +548,33 @@ bool renderer_init(Renderer* renderer, int window_width, int window_height) {
         return false;
     }
     
+    // Load present shader (same full-screen quad)
+    renderer->present_shader = shader_create_program("shaders/fade.vert", "shaders/present.frag");
+    
+    if (!renderer->present_shader.is_valid) {
+        fprintf(stderr, "Error: Failed to create present shader program\n");
+        return false;
+    }
+    
     // Get uniform locations
-    renderer->particle_projection_loc = glGetUniformLocation(renderer->particle_shader.program_id, "u_projection");
-    renderer->fade_color_loc = glGetUniformLocation(renderer->fade_shader.program_id, "u_fade_color");
+    renderer->particle_colormap_loc = glGetUniformLocation(renderer->particle_shader.program_id, "u_colormap");
+    renderer->particle_weight_loc = glGetUniformLocation(renderer->particle_shader.program_id, "u_weight");
+    renderer->quad_colormap_loc = glGetUniformLocation(renderer->quad_shader.program_id, "u_colormap");
+    renderer->quad_pixel_loc = glGetUniformLocation(renderer->quad_shader.program_id, "u_pixel");
+    renderer->quad_width_loc = glGetUniformLocation(renderer->quad_shader.program_id, "u_width");
+    renderer->quad_alpha_loc = glGetUniformLocation(renderer->quad_shader.program_id, "u_alpha");
+    renderer->quad_weight_loc = glGetUniformLocation(renderer->quad_shader.program_id, "u_weight");
+    renderer->trail_history_loc = glGetUniformLocation(renderer->trail_shader.program_id, "u_history");
+    renderer->trail_state_loc = glGetUniformLocation(renderer->trail_shader.program_id, "u_state");
+    renderer->trail_colormap_loc = glGetUniformLocation(renderer->trail_shader.program_id, "u_colormap");
+    renderer->trail_view_loc = glGetUniformLocation(renderer->trail_shader.program_id, "u_view");
+    renderer->trail_rows_loc = glGetUniformLocation(renderer->trail_shader.program_id, "u_rows");
+    renderer->trail_alpha_loc = glGetUniformLocation(renderer->trail_shader.program_id, "u_alpha");
+    renderer->trail_weight_loc = glGetUniformLocation(renderer->trail_shader.program_id, "u_weight");
+    renderer->fade_previous_loc = glGetUniformLocation(renderer->fade_shader.program_id, "u_previous");
+    renderer->fade_retain_loc = glGetUniformLocation(renderer->fade_shader.program_id, "u_retain");
+    renderer->present_accumulation_loc = glGetUniformLocation(renderer->present_shader.program_id,
+                                                              "u_accumulation");
     
     check_gl_error("Shader uniform locations");
     
@@ -127,123 +598,277 @@ bool renderer_init(Renderer* renderer, int window_width, int window_height) {
     return true;
 }
 
-void renderer_update_particles(Renderer* renderer, const ParticleSystem* ps) {
-    if (!renderer || !renderer->initialized || !ps || ps->count == 0) return;
+bool renderer_init_software(Renderer* renderer, int window_width, int window_height) {
+    if (!renderer) return false;
     
-    // Allocate vertex data (2 vertices per particle for line rendering)
-    ParticleVertex* vertices = (ParticleVertex*)malloc(sizeof(ParticleVertex) * ps->count * 2);
-    if (!vertices) {
-        fprintf(stderr, "Error: Failed to allocate particle vertices\n");
-        return;
+    renderer->software = soft_renderer_create(renderer->pool, window_width, window_height);
+    if (!renderer->software) return false;
+    renderer->viewport_width = renderer->software->viewport_width;
+    renderer->viewport_height = renderer->software->viewport_height;
+    
+    printf("Renderer initialized successfully (software, %d workers)\n", renderer->software->workers);
+    return true;
+}
+
+bool renderer_begin_particles(Renderer* renderer, ParticleSystem* ps, const Config* config,
+                              const Camera* cam, float alpha, ParticleEmitter* emitter) {
+    if (renderer && renderer->software) {
+        return soft_renderer_begin_particles(renderer->software, ps, config, cam, alpha, emitter);
+    }
+    if (!renderer || !renderer->initialized || !ps || !config || !cam) return false;
+    renderer->particle_count = 0;
+    if (ps->count == 0) return false;
+    
+    // Lines take 2 vertices per particle, quads one instance
+    RenderMode mode = config->render_mode == RENDER_QUADS ? RENDER_QUADS : RENDER_LINES;
+    size_t bytes = (size_t)ps->count * (mode == RENDER_QUADS ? sizeof(ParticleInstance)
+                                                             : 2 * sizeof(ParticleVertex));
+    if (!ring_reserve(renderer, bytes)) return false;
+    
+    // Write this frame's vertices straight into its region once the GPU
+    // has finished the draw that last read it
+    VertexRing* ring = &renderer->ring;
+    ring_wait(ring, ring->region);
+    size_t offset = ring->region_size * (size_t)ring->region;
+    
+    void* target;
+    if (ring->persistent) {
+        target = (char*)ring->mapped + offset;
+    } else {
+        // The fence already orders the GPU's reads, so skip the driver's sync
+        glBindBuffer(GL_ARRAY_BUFFER, ring->buffer);
+        target = glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)offset, (GLsizeiptr)bytes,
+                                  GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                  GL_MAP_INVALIDATE_RANGE_BIT);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        if (!target) {
+            fprintf(stderr, "Error: Failed to map particle vertices\n");
+            return false;
+        }
     }
     
-    // Build vertex data (lines from prev_position to position)
-    for (int i = 0; i < ps->count; i++) {
-        const Particle* p = &ps->particles[i];
-        int idx = i * 2;
-        
-        // Start vertex (previous position)
-        vertices[idx].position[0] = p->prev_position.x;
-        vertices[idx].position[1] = p->prev_position.y;
-        vertices[idx].color[0] = p->color[0];
-        vertices[idx].color[1] = p->color[1];
-        vertices[idx].color[2] = p->color[2];
-        vertices[idx].color[3] = p->color[3] * 0.5f;
-        
-        // End vertex (current position)
-        vertices[idx + 1].position[0] = p->position.x;
-        vertices[idx + 1].position[1] = p->position.y;
-        vertices[idx + 1].color[0] = p->color[0];
-        vertices[idx + 1].color[1] = p->color[1];
-        vertices[idx + 1].color[2] = p->color[2];
-        vertices[idx + 1].color[3] = p->color[3];
-    }
-    
-    // Upload to GPU
-    glBindBuffer(GL_ARRAY_BUFFER, renderer->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(ParticleVertex) * ps->count * 2, 
-                 vertices, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // Records are relative to the camera: clip space coordinates are
+    // halved to fit the normalized shorts
+    float left, right, bottom, top;
+    camera_get_view_bounds(cam, &left, &right, &bottom, &top);
+    ParticleEmit* emit = &renderer->emit;
+    emit->target = target;
+    emit->mode = mode;
+    emit->alpha = alpha;
+    emit->center_x = (left + right) * 0.5f;
+    emit->center_y = (bottom + top) * 0.5f;
+    emit->scale_x = 1.0f / (right - left);
+    emit->scale_y = 1.0f / (top - bottom);
+    emit->offset = offset;
+    emit->count = ps->count;
+    
+    if (emitter) {
+        emitter->emit = emit_particles;
+        emitter->ctx = emit;
+    }
+    return true;
+}
+
+void renderer_end_particles(Renderer* renderer) {
+    if (renderer && renderer->software) {
+        soft_renderer_end_particles(renderer->software);
+        return;
+    }
+    if (!renderer || !renderer->emit.target) return;
     
-    renderer->particle_count = ps->count * 2;
+    if (!renderer->ring.persistent) {
+        glBindBuffer(GL_ARRAY_BUFFER, renderer->ring.buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
     
-    free(vertices);
+    renderer->records = 0;
+    renderer->frame_offset = renderer->emit.offset;
+    renderer->mode = renderer->emit.mode;
+    renderer->particle_count = renderer->emit.count;
+    renderer->emit.target = NULL;
     check_gl_error("Update particles");
 }
 
+void renderer_update_particles(Renderer* renderer, ParticleSystem* ps, const Config* config,
+                               const Camera* cam, float alpha) {
+    if (renderer && renderer->software) {
+        soft_renderer_update_particles(renderer->software, ps, config, cam, alpha);
+        return;
+    }
+    if (!renderer_begin_particles(renderer, ps, config, cam, alpha, NULL)) return;
+    
+    // Build vertex data on the worker pool
+    VertexBuildJob job = { ps, &renderer->emit };
+    thread_pool_run(renderer->pool, ps->count, VERTEX_MIN_CHUNK, build_vertices_chunk, &job);
+    renderer_end_particles(renderer);
+}
+
+void renderer_attach_particles(Renderer* renderer, unsigned int records, RenderMode mode, int count) {
+    if (!renderer || renderer->software) return;
+    renderer->records = records;
+    renderer->frame_offset = 0;
+    renderer->mode = mode;
+    renderer->particle_count = records ? count : 0;
+}
+
+void renderer_record_trails(Renderer* renderer, const ParticleSystem* ps, const Config* config) {
+    if (!renderer || renderer->software || !renderer->initialized) return;
+    trails_push(&renderer->trails, ps, trail_length(renderer, ps, config));
+}
+
 void renderer_request_clear(Renderer* renderer) {
     if (renderer) {
         renderer->should_clear = true;
+        soft_renderer_request_clear(renderer->software);
     }
 }
 
-void renderer_draw(Renderer* renderer, const ParticleSystem* ps, const Config* config, const Camera* cam) {
-    if (!renderer || !renderer->initialized || !ps || renderer->particle_count == 0) return;
+void renderer_draw(Renderer* renderer, const ParticleSystem* ps, const Config* config, const Camera* cam,
+                   float frame_time) {
+    if (renderer && renderer->software) {
+        // No trails: the software path always fades
+        soft_renderer_draw(renderer->software, config, frame_time);
+        return;
+    }
+    if (!renderer || !renderer->initialized || renderer->particle_count == 0) return;
+    
+    // The result is presented to whatever framebuffer the caller has bound
+    GLint target = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+    
+    float scale = config->render_scale < MIN_RENDER_SCALE ? MIN_RENDER_SCALE
+                : (config->render_scale > 1.0f ? 1.0f : config->render_scale);
+    int width = (int)(renderer->viewport_width * scale + 0.5f);
+    int height = (int)(renderer->viewport_height * scale + 0.5f);
+    Accumulation* accumulation = &renderer->accumulation;
+    if (!accumulation_reserve(accumulation, width > 0 ? width : 1, height > 0 ? height : 1)) return;
+    
+    frame_time = frame_time < 0.0f ? 0.0f : (frame_time > FADE_MAX_FRAME_TIME ? FADE_MAX_FRAME_TIME : frame_time);
+    float frames = frame_time * FADE_REFERENCE_RATE;  // Reference frames this frame stands for
+    float retain = powf(1.0f - FADE_PER_FRAME, frames);
+    
+    // Real trails replace the fade: each frame starts from a clear screen.
+    // Their rows come from renderer_record_trails.
+    if (renderer->trails.length && trail_length(renderer, ps, config) == 0) trails_release(&renderer->trails);
+    bool trails = renderer->trails.length >= 2 && renderer->trails.count > 0;
+    
+    // Draw into the other buffer, starting from the faded latest frame
+    int previous = accumulation->current;
+    accumulation->current = 1 - previous;
+    glBindFramebuffer(GL_FRAMEBUFFER, accumulation->framebuffers[accumulation->current]);
+    glViewport(0, 0, accumulation->width, accumulation->height);
     
     // Handle clear request
-    if (renderer->should_clear) {
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    if (renderer->should_clear || trails) {
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
         glClear(GL_COLOR_BUFFER_BIT);
         renderer->should_clear = false;
     } else {
         glUseProgram(renderer->fade_shader.program_id);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBlendFunc(GL_ONE, GL_ZERO);
         
         glBindVertexArray(renderer->fade_vao);
-        
-        float fade_color[4] = {0.0f, 0.0f, 0.0f, 0.08f};  // Was 0.015f
-        glUniform4fv(renderer->fade_color_loc, 1, fade_color);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, accumulation->textures[previous]);
+        glUniform1i(renderer->fade_previous_loc, 0);
+        glUniform1f(renderer->fade_retain_loc, retain);
         
         glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
         
         check_gl_error("Draw fade");
     }
     
-    // Get camera view bounds
-    float left, right, bottom, top;
-    camera_get_view_bounds(cam, &left, &right, &bottom, &top);
-    
-    // Create orthographic projection matrix
-    float projection[16] = {
-        2.0f / (right - left), 0.0f, 0.0f, 0.0f,
-        0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
-        0.0f, 0.0f, -1.0f, 0.0f,
-        -(right + left) / (right - left), -(top + bottom) / (top - bottom), 0.0f, 1.0f
-    };
+    // CPU records cover the whole path since the last frame, so a long frame
+    // deposits more by itself; GPU records hold the last step only and scale
+    // with the frame time instead. Either way the balance of fading and
+    // drawing (the look) doesn't depend on the frame rate.
+    float balance = fade_deposit_balance(frames, retain);
+    float weight = trails ? 1.0f : (renderer->records ? frames * balance : balance);
     
-    glUseProgram(renderer->particle_shader.program_id);
+    // Vertices are already relative to the camera (see renderer_update_particles)
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_1D, renderer->colormap);
+    if (trails) trails_draw(renderer, cam);
+    ring_bind_frame(renderer);
+    
+    if (renderer->mode == RENDER_QUADS) {
+        // Each instance expands to a particle_size pixels wide strip
+        glUseProgram(renderer->quad_shader.program_id);
+        glUniform1i(renderer->quad_colormap_loc, 0);
+        glUniform2f(renderer->quad_pixel_loc,
+                    2.0f / (float)renderer->viewport_width, 2.0f / (float)renderer->viewport_height);
+        glUniform1f(renderer->quad_width_loc, config->particle_size);
+        glUniform1f(renderer->quad_alpha_loc, PARTICLE_ALPHA);
+        glUniform1f(renderer->quad_weight_loc, weight);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, renderer->particle_count);
+    } else {
+        // Draw all particle trails as lines, 1.5 window pixels wide
+        glUseProgram(renderer->particle_shader.program_id);
+        glUniform1i(renderer->particle_colormap_loc, 0);
+        glUniform1f(renderer->particle_weight_loc, weight);
+        glLineWidth(1.5f * scale > 1.0f ? 1.5f * scale : 1.0f);
+        glDrawArrays(GL_LINES, 0, renderer->particle_count * 2);
+    }
     
-    glUniformMatrix4fv(renderer->particle_projection_loc, 1, GL_FALSE, projection);
+    // Fence the region; the next update moves on to the following one
+    VertexRing* ring = &renderer->ring;
+    if (ring->fences[ring->region]) glDeleteSync(ring->fences[ring->region]);
+    ring->fences[ring->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ring->region = (ring->region + 1) % RENDERER_RING_FRAMES;
     
-    glBindVertexArray(renderer->vao);
-    glLineWidth(1.5f);
+    check_gl_error("Draw particles");
     
-    // Draw all particle trails as lines
-    glDrawArrays(GL_LINES, 0, renderer->particle_count);
+    // Present: tone map the accumulation, scaled up to the whole viewport
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)target);
+    glViewport(0, 0, renderer->viewport_width, renderer->viewport_height);
+    glUseProgram(renderer->present_shader.program_id);
+    glBlendFunc(GL_ONE, GL_ZERO);
+    glBindVertexArray(renderer->fade_vao);
+    glBindTexture(GL_TEXTURE_1D, 0);
+    glBindTexture(GL_TEXTURE_2D, accumulation->textures[accumulation->current]);
+    glUniform1i(renderer->present_accumulation_loc, 0);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
     
-    check_gl_error("Draw particles");
+    check_gl_error("Present");
     
     // Cleanup
+    glBindTexture(GL_TEXTURE_2D, 0);
     glBindVertexArray(0);
     glUseProgram(0);
 }
 
 void renderer_set_viewport(Renderer* renderer, int width, int height) {
     if (!renderer) return;
-    glViewport(0, 0, width, height);
+    renderer->viewport_width = width > 0 ? width : 1;
+    renderer->viewport_height = height > 0 ? height : 1;
+    if (renderer->software) {
+        soft_renderer_set_viewport(renderer->software, renderer->viewport_width, renderer->viewport_height);
+    } else {
+        glViewport(0, 0, width, height);
+    }
 }
 
 void renderer_destroy(Renderer* renderer) {
     if (renderer) {
         if (renderer->initialized) {
+            ring_release(&renderer->ring);
+            trails_release(&renderer->trails);
+            accumulation_release(&renderer->accumulation);
             glDeleteVertexArrays(1, &renderer->vao);
-            glDeleteBuffers(1, &renderer->vbo);
+            glDeleteVertexArrays(1, &renderer->instance_vao);
+            glDeleteTextures(1, &renderer->colormap);
             glDeleteVertexArrays(1, &renderer->fade_vao);
             glDeleteBuffers(1, &renderer->fade_vbo);
             shader_delete(&renderer->particle_shader);
+            shader_delete(&renderer->quad_shader);
+            shader_delete(&renderer->trail_shader);
             shader_delete(&renderer->fade_shader);
+            shader_delete(&renderer->present_shader);
         }
+        soft_renderer_destroy(renderer->software);
         free(renderer);
     }
 }
\ No newline at end of file
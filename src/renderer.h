@@ -5,47 +5,220 @@
 #include "config.h"
 #include "shader.h"
 #include "camera.h"
+#include "thread_pool.h"
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <GL/gl.h>
 
+// Frames of vertex data in flight: the CPU fills one region of the ring
+// while the GPU may still draw from the other two
+#define RENDERER_RING_FRAMES 3
+
+// Streaming vertex buffer, one region per frame in flight. Regions are
+// reused once the fence of the draw that read them has signaled.
+typedef struct {
+    unsigned int buffer;
+    size_t region_size;          // Bytes of one region
+    int region;                  // Region of the current frame
+    void* mapped;                // Persistent mapping of the whole ring (NULL = map per frame)
+    GLsync fences[RENDERER_RING_FRAMES];  // Last draw from each region (NULL = idle)
+    bool persistent;             // GL_ARB_buffer_storage is available
+} VertexRing;
+
+// Particle alpha (head vertex; the tail vertex gets half)
+#define PARTICLE_ALPHA 0.3f
+
+// Texels of the speed colormap
+#define COLORMAP_SIZE 256
+
+// Fraction of the accumulated image that fades per frame at the reference
+// frame rate. Other rates fade in proportion to their frame time; segments
+// cover the path since the last frame, so deposits grow with it too.
+#define FADE_PER_FRAME 0.08f
+#define FADE_REFERENCE_RATE 60.0f
+
+// Longest frame time applied (a stall fades like this much time)
+#define FADE_MAX_FRAME_TIME 0.25f
+
+// Deposit weight of a frame standing for `frames` reference frames that
+// keeps `retain` of the last image. Its path was laid down over the whole
+// frame, so it is weighted by the fade of a reference frame over the mean
+// fade across it: the steady image then doesn't depend on the frame rate.
+static inline float fade_deposit_balance(float frames, float retain) {
+    return frames > 0.0f ? (1.0f - retain) / (frames * FADE_PER_FRAME) : 1.0f;
+}
+
+// Smallest render_scale (accumulation resolution relative to the window)
+#define MIN_RENDER_SCALE 0.25f
+
+// Map normalized speed (0-1) to a blue -> cyan -> orange gradient
+static inline void particle_color_from_speed(float speed, float color[3]) {
+    if (speed < 0.5f) {
+        float t = speed * 2.0f;
+        color[0] = 0.0f;
+        color[1] = 0.5f + t * 0.5f;
+        color[2] = 1.0f;
+    } else {
+        float t = (speed - 0.5f) * 2.0f;
+        color[0] = t;
+        color[1] = 1.0f - t * 0.3f;
+        color[2] = 1.0f - t;
+    }
+}
+
+// Longest trail_length drawn (positions per trail)
+#define RENDERER_MAX_TRAIL 64
+
+// GPU history of the last `length` positions of every particle, one column
+// per particle (ParticleSystem.trail_slot) and one row per simulation step.
+// Each step uploads only its own row, plus each column's age and speed.
+typedef struct {
+    unsigned int history;          // Texture buffer (RG32F world positions), row-major
+    unsigned int history_texture;
+    unsigned int state;            // Texture buffer (RG8UI: valid positions, speed * 255)
+    unsigned int state_texture;
+    int capacity;                  // Columns
+    int length;                    // Rows (0 = no trails)
+    int newest;                    // Row of the latest position
+    float* row;                    // Staging for one row, by column
+    unsigned char* columns;        // Staging for the state, by column
+    float* generations;            // ParticleSystem.generation of each column at the latest row
+    unsigned int frame;            // ParticleSystem.frame of the latest row
+    int count;                     // Particles in the latest row
+} TrailHistory;
+
+// Off-screen HDR accumulation of the particle segments (two RGBA16F
+// framebuffers). Each frame fades the latest one into the other, draws on
+// top, then tone maps the result to the window.
+typedef struct {
+    unsigned int framebuffers[2];
+    unsigned int textures[2];
+    int width, height;             // Texels (viewport * render_scale)
+    int current;                   // Buffer holding the latest frame
+} Accumulation;
+
+// Records of the frame being written (see renderer_begin_particles)
+typedef struct {
+    void* target;              // Mapped ParticleVertex pairs or ParticleInstances (NULL = none)
+    RenderMode mode;
+    float alpha;               // Render time between the previous and current step
+    float center_x, center_y;  // View center
+    float scale_x, scale_y;    // Vertex position units per world unit
+    size_t offset;             // Byte offset of the records in the ring
+    int count;                 // Particles
+} ParticleEmit;
+
 // Renderer structure
 typedef struct {
     // Particle rendering
-    unsigned int vao;
-    unsigned int vbo;
+    unsigned int vao;            // RENDER_LINES: ParticleVertex pairs
+    unsigned int instance_vao;   // RENDER_QUADS: one ParticleInstance per particle
+    VertexRing ring;
+    size_t frame_offset;         // Byte offset of the current frame's records in the ring
+    unsigned int records;        // Buffer of the current frame's records instead of the ring (0 = ring)
+    RenderMode mode;             // Layout of the current frame's records
+    ParticleEmit emit;           // Next frame's records, between begin and end
+    TrailHistory trails;
+    Accumulation accumulation;
     
-    // Fade effect rendering
+    // Fade effect rendering (full-screen quad, also used by the present pass)
     unsigned int fade_vao;
     unsigned int fade_vbo;
     
     // Shader programs (separate for particles and fade)
     ShaderProgram particle_shader;
+    ShaderProgram quad_shader;
+    ShaderProgram trail_shader;
     ShaderProgram fade_shader;
+    ShaderProgram present_shader;
+    
+    // Speed colormap (1D texture), applied by the particle vertex shader
+    unsigned int colormap;
     
     // Particle shader uniform locations
-    int particle_projection_loc;
+    int particle_colormap_loc;
+    int particle_weight_loc;
+    int quad_colormap_loc;
+    int quad_pixel_loc;
+    int quad_width_loc;
+    int quad_alpha_loc;
+    int quad_weight_loc;
+    int trail_history_loc;
+    int trail_state_loc;
+    int trail_colormap_loc;
+    int trail_view_loc;
+    int trail_rows_loc;
+    int trail_alpha_loc;
+    int trail_weight_loc;
+    
+    // Fade and present shader uniform locations
+    int fade_previous_loc;
+    int fade_retain_loc;
+    int present_accumulation_loc;
+    
+    // Vertex build runs on the shared worker pool (may be NULL)
+    ThreadPool* pool;
     
-    // Fade shader uniform locations
-    int fade_projection_loc;
-    int fade_color_loc;
+    // CPU rasterizer drawing in place of OpenGL (see renderer_init_software)
+    struct SoftRenderer* software;
     
     // Rendering state
-    int particle_count;
+    int particle_count;          // Particles in the current frame's records
+    int viewport_width, viewport_height;
     bool initialized;
     bool should_clear;
 } Renderer;
 
-// Vertex data structure for GPU
+// Vertex data structure for GPU (8 bytes), all normalized shorts
 typedef struct {
-    float position[2];
-    float color[4];
+    int16_t position[2];  // Clip space position / 2, so the respawn margin stays in range
+    int16_t speed;        // Normalized speed 0-1, colored by the colormap
+    int16_t alpha;
 } ParticleVertex;
 
-Renderer* renderer_create();
+// Instance data for the quad path (12 bytes): the segment of one particle,
+// expanded by the vertex shader
+typedef struct {
+    int16_t segment[4];   // Tail and head, clip space position / 2
+    int16_t speed;        // Normalized speed 0-1
+    int16_t padding;
+} ParticleInstance;
+
+Renderer* renderer_create(ThreadPool* pool);
 bool renderer_init(Renderer* renderer, int window_width, int window_height);
-void renderer_update_particles(Renderer* renderer, const ParticleSystem* ps);
-void renderer_draw(Renderer* renderer, const ParticleSystem* ps, const Config* config, const Camera* cam);
+// Draw with the software rasterizer (soft_renderer.h) instead: no GL context
+// is needed, and each frame lands in renderer->software->pixels. Records
+// written on the GPU can't be attached.
+bool renderer_init_software(Renderer* renderer, int window_width, int window_height);
+// Fused emission: map the next frame's records for ps->count particles and
+// hand out an emitter whose callback writes the records of any particle
+// range. Workers of particle_system_update_emit fill their own chunks; then
+// renderer_end_particles commits the frame. Returns false (nothing to
+// write, the frame draws nothing) if the records can't be mapped. Each
+// particle's segment runs from its frame position (ps->frame_x/frame_y) to
+// its render position, which becomes the new frame position: emit once
+// per frame.
+// alpha: render time between the previous (0) and current (1) simulation step
+bool renderer_begin_particles(Renderer* renderer, ParticleSystem* ps, const Config* config,
+                              const Camera* cam, float alpha, ParticleEmitter* emitter);
+void renderer_end_particles(Renderer* renderer);
+// Same as begin, a separate pass over all particles on the pool, and end
+void renderer_update_particles(Renderer* renderer, ParticleSystem* ps, const Config* config,
+                               const Camera* cam, float alpha);
+// Draw the next frames from `count` records in a buffer written on the GPU
+// (see gpu_particles.h) until renderer_end_particles commits a ring frame
+void renderer_attach_particles(Renderer* renderer, unsigned int records, RenderMode mode, int count);
+// Append the particles' positions to the trail history; call after every
+// simulation step. Does nothing unless trail_length >= 2 (and on the
+// software renderer).
+void renderer_record_trails(Renderer* renderer, const ParticleSystem* ps, const Config* config);
+// ps: CPU particles for trails (NULL = none)
+// frame_time: wall time since the previous frame (seconds), drives the fade
+// (and the deposit of GPU records, which draw the last step only)
+void renderer_draw(Renderer* renderer, const ParticleSystem* ps, const Config* config, const Camera* cam,
+                   float frame_time);
 void renderer_set_viewport(Renderer* renderer, int width, int height);
 void renderer_request_clear(Renderer* renderer);
 void renderer_destroy(Renderer* renderer);
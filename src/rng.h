@@ -0,0 +1,135 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Counter-based random numbers: Philox4x32-10 (Salmon et al., "Parallel
+// Random Numbers: As Easy as 1, 2, 3"). Output is a pure function of
+// (seed, counter), so each particle draws from
+//   counter = (particle index, frame, stream, 0)
+// with no shared state. Results don't depend on thread count, chunking or
+// evaluation order, and a loop over particles has no carried dependency.
+
+// Independent streams, one per use site
+typedef enum {
+    RNG_STREAM_RECYCLE,       // Per-frame density recycle test (rng_uniform_batch)
+    RNG_STREAM_RESPAWN,       // Spawn position and lifetime of respawned particles
+    RNG_STREAM_REDISTRIBUTE,  // particle_system_redistribute
+    RNG_STREAM_GRID,          // particle_system_redistribute_grid
+} RngStream;
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u  // Key schedule (golden ratio)
+#define PHILOX_W1 0xBB67AE85u  // Key schedule (sqrt(3) - 1)
+
+static inline uint32_t philox_mulhilo(uint32_t a, uint32_t b, uint32_t* hi) {
+    uint64_t p = (uint64_t)a * b;
+    *hi = (uint32_t)(p >> 32);
+    return (uint32_t)p;
+}
+
+// Four 32-bit outputs for one counter
+static inline void rng_philox4x32(const uint32_t counter[4], uint64_t seed, uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+
+    for (int round = 0; round < 10; round++) {
+        uint32_t hi0, hi1;
+        uint32_t lo0 = philox_mulhilo(PHILOX_M0, c0, &hi0);
+        uint32_t lo1 = philox_mulhilo(PHILOX_M1, c2, &hi1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// Uniform float in [0, 1) from the top 24 bits (exact in single precision)
+static inline float rng_unit(uint32_t bits) {
+    return (float)(bits >> 8) * (1.0f / 16777216.0f);
+}
+
+// Four uniform floats in [0, 1) for particle `index`
+static inline void rng_uniform4(uint64_t seed, int index, uint32_t frame, RngStream stream, float out[4]) {
+    uint32_t counter[4] = { (uint32_t)index, frame, (uint32_t)stream, 0 };
+    uint32_t bits[4];
+    rng_philox4x32(counter, seed, bits);
+    for (int k = 0; k < 4; k++) {
+        out[k] = rng_unit(bits[k]);
+    }
+}
+
+// Philox on RNG_LANES counters at once. Written lane-wise with 32x32->64
+// multiplies so the compiler vectorizes it (pmuludq on plain SSE2);
+// bit-identical to rng_philox4x32 per lane.
+#define RNG_LANES 8
+
+static inline void rng_philox4x32_lanes(uint32_t* restrict c0, uint32_t* restrict c1,
+                                        uint32_t* restrict c2, uint32_t* restrict c3, uint64_t seed) {
+    uint32_t k0 = (uint32_t)seed, k1 = (uint32_t)(seed >> 32);
+
+    for (int round = 0; round < 10; round++) {
+        for (int l = 0; l < RNG_LANES; l++) {
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0[l];
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2[l];
+            uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1[l] ^ k0;
+            uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3[l] ^ k1;
+            c1[l] = (uint32_t)p1;
+            c3[l] = (uint32_t)p0;
+            c0[l] = n0;
+            c2[l] = n2;
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+// One uniform float for particle `index` out of a block shared by four
+// consecutive particles: word (index & 3) of counter (index >> 2, frame, stream, 0)
+static inline float rng_uniform1(uint64_t seed, int index, uint32_t frame, RngStream stream) {
+    uint32_t counter[4] = { (uint32_t)index >> 2, frame, (uint32_t)stream, 0 };
+    uint32_t bits[4];
+    rng_philox4x32(counter, seed, bits);
+    return rng_unit(bits[index & 3]);
+}
+
+// rng_uniform1 for particles [first, first + n). Used for per-frame draws
+// that every particle needs; one Philox block serves four particles.
+static inline void rng_uniform_batch(uint64_t seed, int first, int n, uint32_t frame, RngStream stream,
+                                     float* restrict u) {
+    int i = 0;
+
+    // Lane-parallel path for block-aligned runs of 4 * RNG_LANES particles
+    if ((first & 3) == 0) {
+        for (; i + 4 * RNG_LANES <= n; i += 4 * RNG_LANES) {
+            uint32_t c0[RNG_LANES], c1[RNG_LANES], c2[RNG_LANES], c3[RNG_LANES];
+            for (int l = 0; l < RNG_LANES; l++) {
+                c0[l] = (uint32_t)(first + i) / 4 + l;
+                c1[l] = frame;
+                c2[l] = (uint32_t)stream;
+                c3[l] = 0;
+            }
+            rng_philox4x32_lanes(c0, c1, c2, c3, seed);
+            for (int l = 0; l < RNG_LANES; l++) {
+                u[i + 4 * l + 0] = rng_unit(c0[l]);
+                u[i + 4 * l + 1] = rng_unit(c1[l]);
+                u[i + 4 * l + 2] = rng_unit(c2[l]);
+                u[i + 4 * l + 3] = rng_unit(c3[l]);
+            }
+        }
+    }
+
+    for (; i < n; i++) {
+        u[i] = rng_uniform1(seed, first + i, frame, stream);
+    }
+}
+
+#endif // RNG_H
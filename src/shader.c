@@ -1,3 +1,4 @@
+#define GL_GLEXT_PROTOTYPES  // glCreateShader, glUniform1f, ... from glext.h
 #include "shader.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -56,7 +57,8 @@ unsigned int shader_compile(const char* source, int shader_type) {
         char* info_log = (char*)malloc(log_length);
         glGetShaderInfoLog(shader, log_length, NULL, info_log);
         
-        const char* shader_type_str = (shader_type == GL_VERTEX_SHADER) ? "VERTEX" : "FRAGMENT";
+        const char* shader_type_str = shader_type == GL_VERTEX_SHADER ? "VERTEX"
+                                    : (shader_type == GL_FRAGMENT_SHADER ? "FRAGMENT" : "COMPUTE");
         printf("Error: %s shader compilation failed:\n%s\n", shader_type_str, info_log);
         
         free(info_log);
@@ -133,6 +135,116 @@ ShaderProgram shader_create_program(const char* vertex_path, const char* fragmen
     return program;
 }
 
+// Join `prelude` and the contents of the files, one newline after each file
+static char* shader_join_sources(const char* prelude, const char* const* paths, int count) {
+    size_t length = strlen(prelude);
+    char* source = (char*)malloc(length + 1);
+    if (!source) {
+        printf("Error: Failed to allocate memory for shader source\n");
+        return NULL;
+    }
+    memcpy(source, prelude, length + 1);
+    for (int i = 0; i < count; i++) {
+        char* part = shader_load_source(paths[i]);
+        if (!part) {
+            free(source);
+            return NULL;
+        }
+        
+        size_t part_length = strlen(part);
+        char* joined = (char*)realloc(source, length + part_length + 2);
+        if (!joined) {
+            printf("Error: Failed to allocate memory for shader source\n");
+            free(part);
+            free(source);
+            return NULL;
+        }
+        source = joined;
+        memcpy(source + length, part, part_length);
+        length += part_length;
+        source[length++] = '\n';
+        source[length] = '\0';
+        free(part);
+    }
+    return source;
+}
+
+// Link a program from a single stage, capturing `varyings` (if any) with
+// transform feedback
+static ShaderProgram shader_link_stage(unsigned int shader, const char* const* varyings,
+                                       int varying_count, bool interleaved, const char* kind) {
+    ShaderProgram program;
+    program.program_id = 0;
+    program.is_valid = false;
+    
+    unsigned int shader_program = glCreateProgram();
+    glAttachShader(shader_program, shader);
+    if (varying_count > 0) {
+        glTransformFeedbackVaryings(shader_program, varying_count, varyings,
+                                    interleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
+    }
+    glLinkProgram(shader_program);
+    glDeleteShader(shader);
+    
+    // Check linking status
+    int success;
+    glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
+    
+    if (!success) {
+        int log_length;
+        glGetProgramiv(shader_program, GL_INFO_LOG_LENGTH, &log_length);
+        
+        char* info_log = (char*)malloc(log_length);
+        glGetProgramInfoLog(shader_program, log_length, NULL, info_log);
+        
+        printf("Error: %s program linking failed:\n%s\n", kind, info_log);
+        
+        free(info_log);
+        glDeleteProgram(shader_program);
+        return program;
+    }
+    
+    program.program_id = shader_program;
+    program.is_valid = true;
+    
+    printf("%s program created successfully (ID: %u)\n", kind, shader_program);
+    return program;
+}
+
+// Compile a prelude followed by several source files into a compute program
+ShaderProgram shader_create_compute(const char* prelude, const char* const* paths, int count) {
+    ShaderProgram program;
+    program.program_id = 0;
+    program.is_valid = false;
+    
+    char* source = shader_join_sources(prelude, paths, count);
+    if (!source) return program;
+    
+    unsigned int compute_shader = shader_compile(source, GL_COMPUTE_SHADER);
+    free(source);
+    if (compute_shader == 0) return program;
+    
+    return shader_link_stage(compute_shader, NULL, 0, false, "Compute");
+}
+
+// Compile a prelude followed by several source files into a vertex-only
+// program whose outputs are captured with transform feedback
+ShaderProgram shader_create_feedback(const char* prelude, const char* const* paths, int count,
+                                     const char* const* varyings, int varying_count, bool interleaved) {
+    ShaderProgram program;
+    program.program_id = 0;
+    program.is_valid = false;
+    
+    char* source = shader_join_sources(prelude, paths, count);
+    if (!source) return program;
+    
+    unsigned int vertex_shader = shader_compile(source, GL_VERTEX_SHADER);
+    free(source);
+    if (vertex_shader == 0) return program;
+    
+    return shader_link_stage(vertex_shader, varyings, varying_count, interleaved, "Feedback");
+}
+
 // Use shader program
 void shader_use(const ShaderProgram* shader) {
     if (shader && shader->is_valid) {
@@ -149,6 +261,14 @@ void shader_set_int(const ShaderProgram* shader, const char* name, int value) {
     }
 }
 
+void shader_set_uint(const ShaderProgram* shader, const char* name, unsigned int value) {
+    if (!shader || !shader->is_valid) return;
+    int location = glGetUniformLocation(shader->program_id, name);
+    if (location != -1) {
+        glUniform1ui(location, value);
+    }
+}
+
 void shader_set_float(const ShaderProgram* shader, const char* name, float value) {
     if (!shader || !shader->is_valid) return;
     int location = glGetUniformLocation(shader->program_id, name);
@@ -18,11 +18,22 @@ unsigned int shader_compile(const char* source, int shader_type);
 // Link vertex and fragment shaders into a program
 ShaderProgram shader_create_program(const char* vertex_path, const char* fragment_path);
 
+// Compile `prelude` (the #version line and any #defines) followed by the
+// concatenation of several source files into a compute program (GL 4.3)
+ShaderProgram shader_create_compute(const char* prelude, const char* const* paths, int count);
+
+// Same for a vertex shader without a fragment stage whose `varyings` are
+// captured with transform feedback (GL 3.0), interleaved into one buffer
+// or one buffer each
+ShaderProgram shader_create_feedback(const char* prelude, const char* const* paths, int count,
+                                     const char* const* varyings, int varying_count, bool interleaved);
+
 // Use shader program
 void shader_use(const ShaderProgram* shader);
 
 // Set uniform values
 void shader_set_int(const ShaderProgram* shader, const char* name, int value);
+void shader_set_uint(const ShaderProgram* shader, const char* name, unsigned int value);
 void shader_set_float(const ShaderProgram* shader, const char* name, float value);
 void shader_set_vec2(const ShaderProgram* shader, const char* name, float x, float y);
 void shader_set_vec3(const ShaderProgram* shader, const char* name, float x, float y, float z);
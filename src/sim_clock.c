@@ -0,0 +1,58 @@
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
+#include "sim_clock.h"
+
+#include <math.h>
+#include <time.h>
+
+SimClock sim_clock_create(float rate_hz, int max_substeps) {
+    SimClock clock;
+    clock.last_time = sim_clock_now();
+    clock.step = rate_hz > 0.0f ? 1.0f / rate_hz : 1.0f / 60.0f;
+    clock.max_substeps = max_substeps > 0 ? max_substeps : 1;
+
+    // First frame runs one step right away
+    clock.accumulator = clock.step;
+    clock.alpha = 1.0f;
+    clock.elapsed = clock.step;
+    clock.dropped = 0;
+    return clock;
+}
+
+double sim_clock_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int sim_clock_advance(SimClock* clock, bool paused) {
+    double now = sim_clock_now();
+    double elapsed = now - clock->last_time;
+    clock->last_time = now;
+    return sim_clock_advance_by(clock, elapsed, paused);
+}
+
+int sim_clock_advance_by(SimClock* clock, double elapsed, bool paused) {
+    clock->elapsed = (float)elapsed;
+
+    if (paused) {
+        // Hold the latest state; one step is due as soon as we resume
+        clock->accumulator = clock->step;
+        clock->alpha = 1.0f;
+        return 0;
+    }
+
+    clock->accumulator += elapsed;
+
+    int steps = (int)(clock->accumulator / clock->step);
+    if (steps > clock->max_substeps) {
+        // Behind by more than the cap (slow frame, window drag, debugger):
+        // drop the backlog instead of spiraling into ever longer frames
+        clock->dropped += (unsigned long)(steps - clock->max_substeps);
+        steps = clock->max_substeps;
+    }
+    // Keep only the partial step (dropped whole steps don't shift the phase)
+    clock->accumulator = fmod(clock->accumulator, clock->step);
+
+    clock->alpha = (float)(clock->accumulator / clock->step);
+    return steps;
+}
@@ -0,0 +1,35 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdbool.h>
+
+// Fixed-timestep simulation clock (wall time, CLOCK_MONOTONIC). Every render
+// frame the elapsed time is added to an accumulator that is drained in whole
+// simulation steps; what is left over becomes the interpolation factor
+// between the last two simulated states.
+typedef struct {
+    double last_time;     // Wall time of the previous advance (seconds)
+    double accumulator;   // Elapsed wall time not simulated yet
+    float step;           // Simulated time per step (seconds)
+    int max_substeps;     // Steps per advance; older backlog is dropped
+    float alpha;          // Render position between the previous (0) and current (1) state
+    float elapsed;        // Wall time covered by the last advance, paused or not (seconds)
+    unsigned long dropped;  // Steps skipped by the max_substeps cap
+} SimClock;
+
+// Clock ticking at rate_hz steps per second of wall time
+SimClock sim_clock_create(float rate_hz, int max_substeps);
+
+// Monotonic wall time in seconds
+double sim_clock_now(void);
+
+// Number of simulation steps to run before rendering this frame (at most
+// max_substeps). Updates alpha. A paused clock runs no steps and shows the
+// latest state.
+int sim_clock_advance(SimClock* clock, bool paused);
+
+// Same for a frame of `elapsed` seconds instead of the wall time since the
+// last advance (offline rendering at a fixed frame rate)
+int sim_clock_advance_by(SimClock* clock, double elapsed, bool paused);
+
+#endif // SIM_CLOCK_H
@@ -0,0 +1,258 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "vector_field.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// =============================================================================
+// ISA Selection
+// =============================================================================
+
+// SIMD_ISA is set per object by the Makefile for the wide variants (together
+// with the matching -m flags); the default build targets the baseline ISA.
+#ifndef SIMD_ISA
+#if defined(__SSE2__)
+#define SIMD_ISA SIMD_ISA_SSE2
+#else
+#define SIMD_ISA SIMD_ISA_NONE
+#endif
+#endif
+
+#define SIMD_CONCAT_(a, b) a##b
+#define SIMD_CONCAT(a, b) SIMD_CONCAT_(a, b)
+
+// Name of a function compiled for a given ISA (e.g. field_3_simd_avx2)
+#define SIMD_NAME_ISA(name, suffix) SIMD_CONCAT(name, SIMD_CONCAT(_simd_, suffix))
+#define SIMD_NAME(name) SIMD_NAME_ISA(name, SIMD_SUFFIX)
+
+// Forced inlining for kernels and math whose tier argument must fold away
+#define SIMD_INLINE static inline __attribute__((always_inline))
+
+// =============================================================================
+// Primitives
+// =============================================================================
+//
+// vf    - vector of SIMD_WIDTH floats
+// vi    - vector of SIMD_WIDTH int32
+// vmask - per-lane comparison result, consumed by vf_select and vmask_any
+//
+// vf_rcp_est / vf_rsqrt_est are hardware estimates good to SIMD_EST_BITS bits
+
+#if SIMD_ISA == SIMD_ISA_AVX512
+
+#include <immintrin.h>
+
+#define SIMD_WIDTH 16
+#define SIMD_SUFFIX avx512
+#define SIMD_EST_BITS 14
+
+typedef __m512 vf;
+typedef __m512i vi;
+typedef __mmask16 vmask;
+
+static inline vf vf_set1(float a) { return _mm512_set1_ps(a); }
+static inline vf vf_load(const float* p) { return _mm512_loadu_ps(p); }
+static inline void vf_store(float* p, vf a) { _mm512_storeu_ps(p, a); }
+static inline vf vf_add(vf a, vf b) { return _mm512_add_ps(a, b); }
+static inline vf vf_sub(vf a, vf b) { return _mm512_sub_ps(a, b); }
+static inline vf vf_mul(vf a, vf b) { return _mm512_mul_ps(a, b); }
+static inline vf vf_div(vf a, vf b) { return _mm512_div_ps(a, b); }
+static inline vf vf_fmadd(vf a, vf b, vf c) { return _mm512_fmadd_ps(a, b, c); }
+static inline vf vf_sqrt(vf a) { return _mm512_sqrt_ps(a); }
+static inline vf vf_rcp_est(vf a) { return _mm512_rcp14_ps(a); }
+static inline vf vf_rsqrt_est(vf a) { return _mm512_rsqrt14_ps(a); }
+static inline vf vf_min(vf a, vf b) { return _mm512_min_ps(a, b); }
+static inline vf vf_max(vf a, vf b) { return _mm512_max_ps(a, b); }
+static inline vf vf_abs(vf a) {
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_set1_epi32(0x7fffffff)));
+}
+static inline vf vf_xor(vf a, vf b) {
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+}
+static inline vmask vf_lt(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+static inline vmask vf_gt(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+static inline vf vf_select(vmask m, vf t, vf f) { return _mm512_mask_blend_ps(m, f, t); }
+static inline int vmask_any(vmask m) { return m != 0; }
+
+static inline vi vf_round_vi(vf a) { return _mm512_cvtps_epi32(a); }
+static inline vf vi_to_vf(vi a) { return _mm512_cvtepi32_ps(a); }
+static inline vi vi_set1(int32_t a) { return _mm512_set1_epi32(a); }
+static inline vi vi_add(vi a, vi b) { return _mm512_add_epi32(a, b); }
+static inline vi vi_sub(vi a, vi b) { return _mm512_sub_epi32(a, b); }
+static inline vi vi_and(vi a, vi b) { return _mm512_and_si512(a, b); }
+static inline void vi_store(int32_t* p, vi a) { _mm512_storeu_si512((void*)p, a); }
+static inline vmask vi_test(vi a, int32_t bits) { return _mm512_test_epi32_mask(a, _mm512_set1_epi32(bits)); }
+static inline vf vi_as_vf(vi a) { return _mm512_castsi512_ps(a); }
+static inline vi vf_as_vi(vf a) { return _mm512_castps_si512(a); }
+#define vi_slli(a, n) _mm512_slli_epi32((a), (n))
+static inline vf vf_gather(const float* p, vi index) { return _mm512_i32gather_ps(index, p, 4); }
+
+#elif SIMD_ISA == SIMD_ISA_AVX2
+
+#include <immintrin.h>
+
+#define SIMD_WIDTH 8
+#define SIMD_SUFFIX avx2
+#define SIMD_EST_BITS 12
+
+typedef __m256 vf;
+typedef __m256i vi;
+typedef __m256 vmask;
+
+static inline vf vf_set1(float a) { return _mm256_set1_ps(a); }
+static inline vf vf_load(const float* p) { return _mm256_loadu_ps(p); }
+static inline void vf_store(float* p, vf a) { _mm256_storeu_ps(p, a); }
+static inline vf vf_add(vf a, vf b) { return _mm256_add_ps(a, b); }
+static inline vf vf_sub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+static inline vf vf_mul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+static inline vf vf_div(vf a, vf b) { return _mm256_div_ps(a, b); }
+static inline vf vf_fmadd(vf a, vf b, vf c) { return _mm256_fmadd_ps(a, b, c); }
+static inline vf vf_sqrt(vf a) { return _mm256_sqrt_ps(a); }
+static inline vf vf_rcp_est(vf a) { return _mm256_rcp_ps(a); }
+static inline vf vf_rsqrt_est(vf a) { return _mm256_rsqrt_ps(a); }
+static inline vf vf_min(vf a, vf b) { return _mm256_min_ps(a, b); }
+static inline vf vf_max(vf a, vf b) { return _mm256_max_ps(a, b); }
+static inline vf vf_abs(vf a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline vf vf_xor(vf a, vf b) { return _mm256_xor_ps(a, b); }
+static inline vmask vf_lt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline vmask vf_gt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline vf vf_select(vmask m, vf t, vf f) { return _mm256_blendv_ps(f, t, m); }
+static inline int vmask_any(vmask m) { return _mm256_movemask_ps(m) != 0; }
+
+static inline vi vf_round_vi(vf a) { return _mm256_cvtps_epi32(a); }
+static inline vf vi_to_vf(vi a) { return _mm256_cvtepi32_ps(a); }
+static inline vi vi_set1(int32_t a) { return _mm256_set1_epi32(a); }
+static inline vi vi_add(vi a, vi b) { return _mm256_add_epi32(a, b); }
+static inline vi vi_sub(vi a, vi b) { return _mm256_sub_epi32(a, b); }
+static inline vi vi_and(vi a, vi b) { return _mm256_and_si256(a, b); }
+static inline void vi_store(int32_t* p, vi a) { _mm256_storeu_si256((__m256i*)p, a); }
+static inline vmask vi_test(vi a, int32_t bits) {
+    vi b = _mm256_set1_epi32(bits);
+    return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(a, b), b));
+}
+static inline vf vi_as_vf(vi a) { return _mm256_castsi256_ps(a); }
+static inline vi vf_as_vi(vf a) { return _mm256_castps_si256(a); }
+#define vi_slli(a, n) _mm256_slli_epi32((a), (n))
+static inline vf vf_gather(const float* p, vi index) { return _mm256_i32gather_ps(p, index, 4); }
+
+#elif SIMD_ISA == SIMD_ISA_SSE2
+
+#include <emmintrin.h>
+
+#define SIMD_WIDTH 4
+#define SIMD_SUFFIX sse2
+#define SIMD_EST_BITS 12
+
+typedef __m128 vf;
+typedef __m128i vi;
+typedef __m128 vmask;
+
+static inline vf vf_set1(float a) { return _mm_set1_ps(a); }
+static inline vf vf_load(const float* p) { return _mm_loadu_ps(p); }
+static inline void vf_store(float* p, vf a) { _mm_storeu_ps(p, a); }
+static inline vf vf_add(vf a, vf b) { return _mm_add_ps(a, b); }
+static inline vf vf_sub(vf a, vf b) { return _mm_sub_ps(a, b); }
+static inline vf vf_mul(vf a, vf b) { return _mm_mul_ps(a, b); }
+static inline vf vf_div(vf a, vf b) { return _mm_div_ps(a, b); }
+static inline vf vf_fmadd(vf a, vf b, vf c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+static inline vf vf_sqrt(vf a) { return _mm_sqrt_ps(a); }
+static inline vf vf_rcp_est(vf a) { return _mm_rcp_ps(a); }
+static inline vf vf_rsqrt_est(vf a) { return _mm_rsqrt_ps(a); }
+static inline vf vf_min(vf a, vf b) { return _mm_min_ps(a, b); }
+static inline vf vf_max(vf a, vf b) { return _mm_max_ps(a, b); }
+static inline vf vf_abs(vf a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline vf vf_xor(vf a, vf b) { return _mm_xor_ps(a, b); }
+static inline vmask vf_lt(vf a, vf b) { return _mm_cmplt_ps(a, b); }
+static inline vmask vf_gt(vf a, vf b) { return _mm_cmpgt_ps(a, b); }
+// No blendv before SSE4.1
+static inline vf vf_select(vmask m, vf t, vf f) { return _mm_or_ps(_mm_and_ps(m, t), _mm_andnot_ps(m, f)); }
+static inline int vmask_any(vmask m) { return _mm_movemask_ps(m) != 0; }
+
+static inline vi vf_round_vi(vf a) { return _mm_cvtps_epi32(a); }
+static inline vf vi_to_vf(vi a) { return _mm_cvtepi32_ps(a); }
+static inline vi vi_set1(int32_t a) { return _mm_set1_epi32(a); }
+static inline vi vi_add(vi a, vi b) { return _mm_add_epi32(a, b); }
+static inline vi vi_sub(vi a, vi b) { return _mm_sub_epi32(a, b); }
+static inline vi vi_and(vi a, vi b) { return _mm_and_si128(a, b); }
+static inline void vi_store(int32_t* p, vi a) { _mm_storeu_si128((__m128i*)p, a); }
+static inline vmask vi_test(vi a, int32_t bits) {
+    vi b = _mm_set1_epi32(bits);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, b), b));
+}
+static inline vf vi_as_vf(vi a) { return _mm_castsi128_ps(a); }
+static inline vi vf_as_vi(vf a) { return _mm_castps_si128(a); }
+#define vi_slli(a, n) _mm_slli_epi32((a), (n))
+// No gather before AVX2
+static inline vf vf_gather(const float* p, vi index) {
+    int32_t i[4];
+    _mm_storeu_si128((__m128i*)i, index);
+    return _mm_setr_ps(p[i[0]], p[i[1]], p[i[2]], p[i[3]]);
+}
+
+#else // SIMD_ISA_NONE: one lane, plain C
+
+#define SIMD_WIDTH 1
+#define SIMD_SUFFIX scalar
+#define SIMD_EST_BITS 24
+
+typedef float vf;
+typedef int32_t vi;
+typedef int vmask;
+
+static inline vf vf_set1(float a) { return a; }
+static inline vf vf_load(const float* p) { return *p; }
+static inline void vf_store(float* p, vf a) { *p = a; }
+static inline vf vf_add(vf a, vf b) { return a + b; }
+static inline vf vf_sub(vf a, vf b) { return a - b; }
+static inline vf vf_mul(vf a, vf b) { return a * b; }
+static inline vf vf_div(vf a, vf b) { return a / b; }
+static inline vf vf_fmadd(vf a, vf b, vf c) { return a * b + c; }
+static inline vf vf_sqrt(vf a) { return sqrtf(a); }
+static inline vf vf_rcp_est(vf a) { return 1.0f / a; }
+static inline vf vf_rsqrt_est(vf a) { return 1.0f / sqrtf(a); }
+static inline vf vf_min(vf a, vf b) { return a < b ? a : b; }
+static inline vf vf_max(vf a, vf b) { return a > b ? a : b; }
+static inline vf vf_abs(vf a) { return fabsf(a); }
+static inline vf vf_xor(vf a, vf b) {
+    uint32_t ua, ub;
+    memcpy(&ua, &a, sizeof(ua));
+    memcpy(&ub, &b, sizeof(ub));
+    ua ^= ub;
+    memcpy(&a, &ua, sizeof(a));
+    return a;
+}
+static inline vmask vf_lt(vf a, vf b) { return a < b; }
+static inline vmask vf_gt(vf a, vf b) { return a > b; }
+static inline vf vf_select(vmask m, vf t, vf f) { return m ? t : f; }
+static inline int vmask_any(vmask m) { return m; }
+
+static inline vi vf_round_vi(vf a) { return (vi)nearbyintf(a); }
+static inline vf vi_to_vf(vi a) { return (vf)a; }
+static inline vi vi_set1(int32_t a) { return a; }
+static inline vi vi_add(vi a, vi b) { return a + b; }
+static inline vi vi_sub(vi a, vi b) { return a - b; }
+static inline vi vi_and(vi a, vi b) { return a & b; }
+static inline void vi_store(int32_t* p, vi a) { *p = a; }
+static inline vmask vi_test(vi a, int32_t bits) { return (a & bits) == bits; }
+static inline vf vi_as_vf(vi a) {
+    vf f;
+    memcpy(&f, &a, sizeof(f));
+    return f;
+}
+static inline vi vf_as_vi(vf a) {
+    vi i;
+    memcpy(&i, &a, sizeof(i));
+    return i;
+}
+#define vi_slli(a, n) ((vi)((uint32_t)(a) << (n)))
+static inline vf vf_gather(const float* p, vi index) { return p[index]; }
+
+#endif
+
+// Lane count is a power of two; rounds n down to whole vectors
+#define SIMD_FLOOR(n) ((n) & ~(SIMD_WIDTH - 1))
+
+#endif // SIMD_H
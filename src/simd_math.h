@@ -0,0 +1,184 @@
+#ifndef SIMD_MATH_H
+#define SIMD_MATH_H
+
+#include "simd.h"
+
+// Vectorized sqrt/rcp/sin/cos/exp/atan2 built on the simd.h primitives.
+// Every function takes a MathPrecision tier, which is a compile-time
+// constant in the field kernels, so only one branch survives:
+//
+//   MATH_PRECISION_REFERENCE - Cephes single-precision polynomials with
+//                              3-part Cody-Waite reduction, exact sqrt/div
+//                              (a few ulp from libm)
+//   MATH_PRECISION_VISUAL    - lower-degree minimax fits, 1-part reduction,
+//                              hardware rcp/rsqrt estimates (~1e-4 relative)
+
+#define SIMD_PI      3.14159265f
+#define SIMD_PI_2    1.57079633f
+#define SIMD_PI_4    0.78539816f
+#define SIMD_2_PI    0.63661977f  // 2 / pi
+
+// =============================================================================
+// Square Root / Reciprocal
+// =============================================================================
+
+// One Newton step takes a 12-bit estimate to ~23 bits
+SIMD_INLINE vf vm_rcp(vf x, MathPrecision prec) {
+    if (prec == MATH_PRECISION_REFERENCE) return vf_div(vf_set1(1.0f), x);
+
+    vf e = vf_rcp_est(x);
+    if (SIMD_EST_BITS < 14) {
+        e = vf_mul(e, vf_fmadd(vf_sub(vf_set1(0.0f), x), e, vf_set1(2.0f)));
+    }
+    return e;
+}
+
+SIMD_INLINE vf vm_sqrt(vf x, MathPrecision prec) {
+    if (prec == MATH_PRECISION_REFERENCE) return vf_sqrt(x);
+
+    vf e = vf_rsqrt_est(x);
+    if (SIMD_EST_BITS < 14) {
+        vf half_x = vf_mul(x, vf_set1(0.5f));
+        e = vf_mul(e, vf_fmadd(vf_sub(vf_set1(0.0f), half_x), vf_mul(e, e), vf_set1(1.5f)));
+    }
+    // sqrt(0) would be 0 * inf
+    return vf_select(vf_gt(x, vf_set1(0.0f)), vf_mul(x, e), vf_set1(0.0f));
+}
+
+// =============================================================================
+// Sine / Cosine
+// =============================================================================
+
+// sin and cos of the same argument; one range reduction for both
+SIMD_INLINE void vm_sincos(vf x, MathPrecision prec, vf* out_sin, vf* out_cos) {
+    // Quadrant q = round(x * 2/pi), r = x - q * pi/2
+    vi q = vf_round_vi(vf_mul(x, vf_set1(SIMD_2_PI)));
+    vf qf = vi_to_vf(q);
+    vf r, r2, ps, pc;
+
+    if (prec == MATH_PRECISION_REFERENCE) {
+        // pi/2 in four parts; the first three are short enough that q * part
+        // is exact even without FMA (for |x| below ~6000)
+        r = vf_fmadd(qf, vf_set1(-1.5703125f), x);
+        r = vf_fmadd(qf, vf_set1(-4.837512969970703125e-4f), r);
+        r = vf_fmadd(qf, vf_set1(-7.549533620476723e-8f), r);
+        r = vf_fmadd(qf, vf_set1(-2.5633440682570896e-12f), r);
+        r2 = vf_mul(r, r);
+
+        ps = vf_fmadd(vf_set1(-1.9515295891e-4f), r2, vf_set1(8.3321608736e-3f));
+        ps = vf_fmadd(ps, r2, vf_set1(-1.6666654611e-1f));
+        ps = vf_fmadd(vf_mul(ps, r2), r, r);
+
+        pc = vf_fmadd(vf_set1(2.443315711809948e-5f), r2, vf_set1(-1.388731625493765e-3f));
+        pc = vf_fmadd(pc, r2, vf_set1(4.166664568298827e-2f));
+        pc = vf_fmadd(vf_mul(pc, r2), r2, vf_fmadd(r2, vf_set1(-0.5f), vf_set1(1.0f)));
+    } else {
+        r = vf_fmadd(qf, vf_set1(-SIMD_PI_2), x);
+        r2 = vf_mul(r, r);
+
+        ps = vf_fmadd(vf_set1(8.16461e-3f), r2, vf_set1(-1.6663458e-1f));
+        ps = vf_fmadd(vf_mul(ps, r2), r, r);
+
+        pc = vf_fmadd(vf_set1(4.048892e-2f), r2, vf_set1(-4.997763e-1f));
+        pc = vf_fmadd(pc, r2, vf_set1(1.0f));
+    }
+
+    // Odd quadrants swap sin and cos; sign bits come from the quadrant
+    vmask swap = vi_test(q, 1);
+    vf s = vf_select(swap, pc, ps);
+    vf c = vf_select(swap, ps, pc);
+    vf sin_sign = vi_as_vf(vi_slli(vi_and(q, vi_set1(2)), 30));
+    vf cos_sign = vi_as_vf(vi_slli(vi_and(vi_add(q, vi_set1(1)), vi_set1(2)), 30));
+    *out_sin = vf_xor(s, sin_sign);
+    *out_cos = vf_xor(c, cos_sign);
+}
+
+SIMD_INLINE vf vm_sin(vf x, MathPrecision prec) {
+    vf s, c;
+    vm_sincos(x, prec, &s, &c);
+    return s;
+}
+
+SIMD_INLINE vf vm_cos(vf x, MathPrecision prec) {
+    vf s, c;
+    vm_sincos(x, prec, &s, &c);
+    return c;
+}
+
+// =============================================================================
+// Exponential
+// =============================================================================
+
+SIMD_INLINE vf vm_exp(vf x, MathPrecision prec) {
+    x = vf_min(vf_max(x, vf_set1(-87.3f)), vf_set1(88.3f));
+
+    // x = n * ln2 + r, |r| <= ln2 / 2
+    vi n = vf_round_vi(vf_mul(x, vf_set1(1.44269504f)));
+    vf nf = vi_to_vf(n);
+    vf p;
+
+    if (prec == MATH_PRECISION_REFERENCE) {
+        vf r = vf_fmadd(nf, vf_set1(-0.693359375f), x);
+        r = vf_fmadd(nf, vf_set1(2.12194440e-4f), r);
+
+        p = vf_fmadd(vf_set1(1.9875691500e-4f), r, vf_set1(1.3981999507e-3f));
+        p = vf_fmadd(p, r, vf_set1(8.3334519073e-3f));
+        p = vf_fmadd(p, r, vf_set1(4.1665795894e-2f));
+        p = vf_fmadd(p, r, vf_set1(1.6666665459e-1f));
+        p = vf_fmadd(p, r, vf_set1(5.0000001201e-1f));
+        p = vf_fmadd(vf_mul(p, r), r, vf_add(r, vf_set1(1.0f)));
+    } else {
+        vf r = vf_fmadd(nf, vf_set1(-0.69314718f), x);
+
+        p = vf_fmadd(vf_set1(1.656683e-1f), r, vf_set1(5.0496331e-1f));
+        p = vf_fmadd(p, r, vf_set1(1.0001642f));
+        p = vf_fmadd(p, r, vf_set1(9.9992807e-1f));
+    }
+
+    // Scale by 2^n through the exponent bits
+    vf pow2n = vi_as_vf(vi_slli(vi_add(n, vi_set1(127)), 23));
+    return vf_mul(p, pow2n);
+}
+
+// =============================================================================
+// Arc Tangent
+// =============================================================================
+
+SIMD_INLINE vf vm_atan2(vf y, vf x, MathPrecision prec) {
+    vf ax = vf_abs(x);
+    vf ay = vf_abs(y);
+    vf hi = vf_max(ax, ay);
+    vf lo = vf_min(ax, ay);
+
+    // t = lo / hi in [0, 1]; atan(0 / 0) is taken as 0
+    vmask zero = vf_lt(hi, vf_set1(1e-30f));
+    vf t = vf_mul(lo, vm_rcp(vf_select(zero, vf_set1(1.0f), hi), prec));
+    vf a;
+
+    if (prec == MATH_PRECISION_REFERENCE) {
+        // Reduce t > tan(pi/8) with atan(t) = pi/4 + atan((t - 1) / (t + 1))
+        vmask big = vf_gt(t, vf_set1(0.41421356f));
+        vf tr = vf_select(big, vf_div(vf_sub(t, vf_set1(1.0f)), vf_add(t, vf_set1(1.0f))), t);
+        vf base = vf_select(big, vf_set1(SIMD_PI_4), vf_set1(0.0f));
+
+        vf z = vf_mul(tr, tr);
+        vf p = vf_fmadd(vf_set1(8.05374449538e-2f), z, vf_set1(-1.38776856032e-1f));
+        p = vf_fmadd(p, z, vf_set1(1.99777106478e-1f));
+        p = vf_fmadd(p, z, vf_set1(-3.33329491539e-1f));
+        a = vf_add(base, vf_fmadd(vf_mul(p, z), tr, tr));
+    } else {
+        // Odd minimax polynomial over all of [0, 1], no reduction
+        vf z = vf_mul(t, t);
+        vf p = vf_fmadd(vf_set1(-3.898634e-2f), z, vf_set1(1.4626423e-1f));
+        p = vf_fmadd(p, z, vf_set1(-3.211749e-1f));
+        p = vf_fmadd(p, z, vf_set1(9.9921381e-1f));
+        a = vf_mul(p, t);
+    }
+
+    // Undo the octant folding
+    a = vf_select(vf_gt(ay, ax), vf_sub(vf_set1(SIMD_PI_2), a), a);
+    a = vf_select(vf_lt(x, vf_set1(0.0f)), vf_sub(vf_set1(SIMD_PI), a), a);
+    return vf_select(vf_lt(y, vf_set1(0.0f)), vf_sub(vf_set1(0.0f), a), a);
+}
+
+#endif // SIMD_MATH_H
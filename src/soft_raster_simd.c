@@ -0,0 +1,129 @@
+#include "soft_renderer.h"
+#include "simd_math.h"
+
+// Tile and present kernels of the software renderer. Like the field
+// kernels, this file is compiled once more per wide ISA; soft_renderer.c
+// picks the widest the CPU runs.
+
+// Tone map knee, as shaders/present.frag
+#define SOFT_KNEE 0.8f
+
+static const float soft_lanes[16] = {
+    0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+    8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f
+};
+
+// Length of the overlap of [lo, hi] with [min, max], at least 0
+SIMD_INLINE vf overlap(vf lo, vf hi, vf min, vf max) {
+    return vf_max(vf_sub(vf_min(hi, max), vf_max(lo, min)), vf_set1(0.0f));
+}
+
+// Add the segments in `list` to the tile, SIMD_WIDTH pixels of a row at a
+// time. A pixel's coverage is a one pixel box filter along and across the
+// segment, so each segment deposits its length times its width however
+// short it is (at usual zooms a step is well under a pixel). Alpha goes
+// linearly from the tail to the head, as the GL vertices do. Deposits are
+// linear in the length, so a path drawn in any number of pieces deposits
+// the same.
+void SIMD_NAME(soft_raster_tile)(const SoftTile* tile, const SoftSegment* segments, const int* list, int count) {
+    vf zero = vf_set1(0.0f);
+    vf one = vf_set1(1.0f);
+    vf half = vf_set1(0.5f);
+    vf lanes = vf_load(soft_lanes);
+    vf half_width = vf_set1(tile->half_width);
+    vf minus_half_width = vf_set1(-tile->half_width);
+    float reach = tile->half_width + 0.5f;  // Farthest pixel center with coverage
+
+    for (int k = 0; k < count; k++) {
+        const SoftSegment* s = &segments[list[k]];
+        float ax = s->ax - tile->x, ay = s->ay - tile->y;
+        float dx = s->bx - s->ax, dy = s->by - s->ay;
+        float length = sqrtf(dx * dx + dy * dy);
+        float ux = 1.0f, uy = 0.0f, inv_length = 0.0f;
+        if (length > 1e-6f) {
+            inv_length = 1.0f / length;
+            ux = dx * inv_length;
+            uy = dy * inv_length;
+        }
+
+        // Pixels around the segment, inside the tile
+        float min_x = (dx < 0.0f ? ax + dx : ax) - reach, max_x = (dx < 0.0f ? ax : ax + dx) + reach;
+        float min_y = (dy < 0.0f ? ay + dy : ay) - reach, max_y = (dy < 0.0f ? ay : ay + dy) + reach;
+        int x0 = min_x > 0.0f ? (int)min_x : 0;
+        int y0 = min_y > 0.0f ? (int)min_y : 0;
+        int x1 = max_x < (float)(tile->width - 1) ? (int)max_x : tile->width - 1;
+        int y1 = max_y < (float)(tile->height - 1) ? (int)max_y : tile->height - 1;
+
+        vf vux = vf_set1(ux), vuy = vf_set1(uy);
+        vf vlength = vf_set1(length);
+        vf vinv_length = vf_set1(inv_length);
+        vf alpha_tail = vf_set1(tile->alpha_tail);
+        vf alpha_span = vf_set1(tile->alpha_head - tile->alpha_tail);
+        vf cr = vf_set1(s->color[0]), cg = vf_set1(s->color[1]), cb = vf_set1(s->color[2]);
+
+        for (int y = y0; y <= y1; y++) {
+            // Pixel centers relative to the tail
+            vf py = vf_set1((float)y + 0.5f - ay);
+            vf py_along = vf_mul(py, vuy);
+            vf py_across = vf_mul(py, vux);
+            int row = y * SOFT_TILE_STRIDE;
+            for (int x = x0; x <= x1; x += SIMD_WIDTH) {
+                vf px = vf_add(lanes, vf_set1((float)x + 0.5f - ax));
+                vf along = vf_fmadd(px, vux, py_along);
+                vf across = vf_abs(vf_sub(py_across, vf_mul(px, vuy)));
+
+                vf coverage = overlap(vf_sub(across, half), vf_add(across, half), minus_half_width, half_width);
+                coverage = vf_mul(coverage, overlap(vf_sub(along, half), vf_add(along, half), zero, vlength));
+                vf t = vf_min(vf_max(vf_mul(along, vinv_length), zero), one);
+                vf a = vf_mul(vf_fmadd(t, alpha_span, alpha_tail), coverage);
+
+                float* r = tile->r + row + x;
+                float* g = tile->g + row + x;
+                float* b = tile->b + row + x;
+                vf_store(r, vf_fmadd(cr, a, vf_load(r)));
+                vf_store(g, vf_fmadd(cg, a, vf_load(g)));
+                vf_store(b, vf_fmadd(cb, a, vf_load(b)));
+            }
+        }
+    }
+}
+
+// Tone map (linear up to the knee, then an exponential shoulder towards
+// white) and pack into BGRA8. Vectors entirely below the knee, most of a
+// frame, skip the shoulder.
+SIMD_INLINE vi present_pack(vf r, vf g, vf b) {
+    vf knee = vf_set1(SOFT_KNEE);
+    vf zero = vf_set1(0.0f);
+    vf unorm = vf_set1(255.0f);
+    vf c[3] = { r, g, b };
+    vi channel[3];
+    for (int i = 0; i < 3; i++) {
+        vf mapped = vf_max(vf_min(c[i], knee), zero);
+        if (vmask_any(vf_gt(c[i], knee))) {
+            vf over = vf_max(vf_sub(c[i], knee), zero);
+            vf fall = vm_exp(vf_mul(over, vf_set1(-1.0f / (1.0f - SOFT_KNEE))), MATH_PRECISION_VISUAL);
+            mapped = vf_fmadd(vf_set1(1.0f - SOFT_KNEE), vf_sub(vf_set1(1.0f), fall), mapped);
+        }
+        channel[i] = vf_round_vi(vf_mul(vf_min(mapped, vf_set1(1.0f)), unorm));
+    }
+    // Channels are disjoint bytes, so adding them packs them
+    vi pixel = vi_add(channel[2], vi_slli(channel[1], 8));
+    pixel = vi_add(pixel, vi_slli(channel[0], 16));
+    return vi_add(pixel, vi_set1((int32_t)0xff000000u));
+}
+
+void SIMD_NAME(soft_present)(const float* r, const float* g, const float* b, uint32_t* pixels, int count) {
+    int full = SIMD_FLOOR(count);
+    for (int i = 0; i < full; i += SIMD_WIDTH) {
+        vi_store((int32_t*)(pixels + i), present_pack(vf_load(r + i), vf_load(g + i), vf_load(b + i)));
+    }
+    if (full < count) {
+        float tr[SIMD_WIDTH] = {0}, tg[SIMD_WIDTH] = {0}, tb[SIMD_WIDTH] = {0};
+        int32_t tp[SIMD_WIDTH];
+        memcpy(tr, r + full, sizeof(float) * (count - full));
+        memcpy(tg, g + full, sizeof(float) * (count - full));
+        memcpy(tb, b + full, sizeof(float) * (count - full));
+        vi_store(tp, present_pack(vf_load(tr), vf_load(tg), vf_load(tb)));
+        memcpy(pixels + full, tp, sizeof(uint32_t) * (count - full));
+    }
+}
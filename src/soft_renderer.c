@@ -0,0 +1,493 @@
+#include "soft_renderer.h"
+#include "simd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Kernels of each ISA (soft_raster_simd.c)
+#define SOFT_DECLARE_KERNELS(suffix) \
+    void SIMD_NAME_ISA(soft_raster_tile, suffix)(const SoftTile* tile, const SoftSegment* segments, \
+                                                 const int* list, int count); \
+    void SIMD_NAME_ISA(soft_present, suffix)(const float* r, const float* g, const float* b, \
+                                             uint32_t* pixels, int count);
+
+SOFT_DECLARE_KERNELS(SIMD_SUFFIX)
+#if defined(__x86_64__)
+SOFT_DECLARE_KERNELS(avx2)
+SOFT_DECLARE_KERNELS(avx512)
+#endif
+
+// Particles per segment emit task
+#define SOFT_EMIT_MIN_CHUNK 4096
+
+// Window rows per present task when the accumulation is scaled
+#define SOFT_PRESENT_MIN_ROWS 8
+
+// Faded values below this are dropped: far under one 8-bit step, and it
+// keeps the exponential fade out of denormals
+#define SOFT_BLACK (1.0f / 65536.0f)
+
+// Floats of one plane of a worker's tile scratch
+#define SOFT_TILE_FLOATS (SOFT_TILE * SOFT_TILE_STRIDE)
+
+// Write segments for particles [begin, end): the path since the last
+// frame, from the frame position to the render position, as the GL
+// renderer's emit_vertices (which also advance the frame position)
+static void emit_segments(void* ctx, ParticleSystem* ps, int begin, int end) {
+    SoftRenderer* sr = (SoftRenderer*)ctx;
+
+    for (int i = begin; i < end; i++) {
+        float x = ps->prev_x[i] + (ps->x[i] - ps->prev_x[i]) * sr->alpha;
+        float y = ps->prev_y[i] + (ps->y[i] - ps->prev_y[i]) * sr->alpha;
+
+        // View units grow downwards, like the window rows
+        SoftSegment* s = &sr->segments[i];
+        s->ax = (ps->frame_x[i] - sr->center_x) * sr->scale_x + 0.5f;
+        s->ay = 0.5f - (ps->frame_y[i] - sr->center_y) * sr->scale_y;
+        s->bx = (x - sr->center_x) * sr->scale_x + 0.5f;
+        s->by = 0.5f - (y - sr->center_y) * sr->scale_y;
+        ps->frame_x[i] = x;
+        ps->frame_y[i] = y;
+
+        // Linear between the colormap texels, as the texture filter
+        float speed = ps->speed[i] < 0.0f ? 0.0f : (ps->speed[i] > 1.0f ? 1.0f : ps->speed[i]);
+        float texel = speed * (COLORMAP_SIZE - 1);
+        int t0 = (int)texel;
+        int t1 = t0 < COLORMAP_SIZE - 1 ? t0 + 1 : t0;
+        float f = texel - (float)t0;
+        for (int c = 0; c < 3; c++) {
+            s->color[c] = sr->colormap[t0][c] + (sr->colormap[t1][c] - sr->colormap[t0][c]) * f;
+        }
+        s->padding = 0.0f;
+    }
+}
+
+static void emit_segments_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const SoftRenderer* sr = (const SoftRenderer*)ctx;
+    emit_segments(ctx, sr->pending_ps, begin, end);
+}
+
+// Segments being binned or drawn this frame
+typedef struct {
+    SoftRenderer* sr;
+    SoftTile style;      // Width and alpha of every tile
+    float retain;        // Fraction of the last frame kept (0 = clear)
+    bool present;        // Accumulation at window size: tiles write the window pixels
+} SoftDrawJob;
+
+// Pixel range of a segment (pixels) widened by `reach`, as tiles; false if
+// it misses the accumulation
+static bool segment_tiles(const SoftRenderer* sr, const SoftSegment* s, float reach,
+                          int* tx0, int* ty0, int* tx1, int* ty1) {
+    float min_x = (s->ax < s->bx ? s->ax : s->bx) - reach;
+    float max_x = (s->ax < s->bx ? s->bx : s->ax) + reach;
+    float min_y = (s->ay < s->by ? s->ay : s->by) - reach;
+    float max_y = (s->ay < s->by ? s->by : s->ay) + reach;
+    // Negated compares also reject NaN
+    if (!(max_x >= 0.0f && max_y >= 0.0f && min_x < (float)sr->width && min_y < (float)sr->height)) {
+        return false;
+    }
+
+    *tx0 = min_x > 0.0f ? (int)min_x / SOFT_TILE : 0;
+    *ty0 = min_y > 0.0f ? (int)min_y / SOFT_TILE : 0;
+    *tx1 = max_x < (float)(sr->width - 1) ? (int)max_x / SOFT_TILE : sr->tiles_x - 1;
+    *ty1 = max_y < (float)(sr->height - 1) ? (int)max_y / SOFT_TILE : sr->tiles_y - 1;
+    return true;
+}
+
+// Segments [begin, end) of the particles split evenly over the workers;
+// fixed ranges keep both binning passes in step
+static void group_range(const SoftRenderer* sr, int group, int* begin, int* end) {
+    *begin = (int)((long long)sr->particle_count * group / sr->workers);
+    *end = (int)((long long)sr->particle_count * (group + 1) / sr->workers);
+}
+
+// Binning pass 1: convert a group's segments to pixels and count them per tile
+static void bin_count_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const SoftDrawJob* job = (const SoftDrawJob*)ctx;
+    SoftRenderer* sr = job->sr;
+    int tiles = sr->tiles_x * sr->tiles_y;
+    float reach = job->style.half_width + 1.0f;
+
+    for (int group = begin; group < end; group++) {
+        int* counts = sr->group_offset + (size_t)group * tiles;
+        memset(counts, 0, sizeof(int) * (size_t)tiles);
+
+        int first, last;
+        group_range(sr, group, &first, &last);
+        for (int i = first; i < last; i++) {
+            // Clamped like the GL vertices (clip space -2 to 2). A frame
+            // drawn again is already converted.
+            SoftSegment* s = &sr->segments[i];
+            if (!sr->in_pixels) {
+                s->ax = fminf(fmaxf(s->ax, -0.5f), 1.5f) * (float)sr->width;
+                s->ay = fminf(fmaxf(s->ay, -0.5f), 1.5f) * (float)sr->height;
+                s->bx = fminf(fmaxf(s->bx, -0.5f), 1.5f) * (float)sr->width;
+                s->by = fminf(fmaxf(s->by, -0.5f), 1.5f) * (float)sr->height;
+            }
+
+            int tx0, ty0, tx1, ty1;
+            if (!segment_tiles(sr, s, reach, &tx0, &ty0, &tx1, &ty1)) continue;
+            for (int ty = ty0; ty <= ty1; ty++) {
+                for (int tx = tx0; tx <= tx1; tx++) counts[ty * sr->tiles_x + tx]++;
+            }
+        }
+    }
+}
+
+// Binning pass 2: each group writes its segment indices from its own offsets
+static void bin_write_chunk(void* ctx, int begin, int end, int worker) {
+    (void)worker;
+    const SoftDrawJob* job = (const SoftDrawJob*)ctx;
+    SoftRenderer* sr = job->sr;
+    int tiles = sr->tiles_x * sr->tiles_y;
+    float reach = job->style.half_width + 1.0f;
+
+    for (int group = begin; group < end; group++) {
+        int* offsets = sr->group_offset + (size_t)group * tiles;
+        int first, last;
+        group_range(sr, group, &first, &last);
+        for (int i = first; i < last; i++) {
+            int tx0, ty0, tx1, ty1;
+            if (!segment_tiles(sr, &sr->segments[i], reach, &tx0, &ty0, &tx1, &ty1)) continue;
+            for (int ty = ty0; ty <= ty1; ty++) {
+                for (int tx = tx0; tx <= tx1; tx++) sr->bins[offsets[ty * sr->tiles_x + tx]++] = i;
+            }
+        }
+    }
+}
+
+// Sort the frame's segments into tiles: within a tile, by group and then
+// by index, which is emission order
+static bool bin_segments(SoftRenderer* sr, SoftDrawJob* job) {
+    int tiles = sr->tiles_x * sr->tiles_y;
+    thread_pool_run(sr->pool, sr->workers, 1, bin_count_chunk, job);
+    sr->in_pixels = true;
+
+    // Counts become write positions, tile-major
+    int total = 0;
+    for (int t = 0; t < tiles; t++) {
+        sr->tile_start[t] = total;
+        for (int group = 0; group < sr->workers; group++) {
+            int* entry = &sr->group_offset[(size_t)group * tiles + t];
+            int count = *entry;
+            *entry = total;
+            total += count;
+        }
+    }
+    sr->tile_start[tiles] = total;
+
+    if (total > sr->bin_capacity) {
+        int* bins = (int*)realloc(sr->bins, sizeof(int) * (size_t)total);
+        if (!bins) {
+            fprintf(stderr, "Error: Failed to allocate %d tile bin entries\n", total);
+            return false;
+        }
+        sr->bins = bins;
+        sr->bin_capacity = total;
+    }
+    thread_pool_run(sr->pool, sr->workers, 1, bin_write_chunk, job);
+    return true;
+}
+
+// Fade, rasterize and store tiles; present them too at full scale
+static void draw_tiles_chunk(void* ctx, int begin, int end, int worker) {
+    const SoftDrawJob* job = (const SoftDrawJob*)ctx;
+    SoftRenderer* sr = job->sr;
+    size_t plane = (size_t)sr->width * sr->height;
+    float* scratch = sr->scratch + sr->scratch_floats * (size_t)worker;
+
+    SoftTile tile = job->style;
+    tile.r = scratch;
+    tile.g = scratch + SOFT_TILE_FLOATS;
+    tile.b = scratch + 2 * SOFT_TILE_FLOATS;
+
+    for (int t = begin; t < end; t++) {
+        int x0 = (t % sr->tiles_x) * SOFT_TILE;
+        int y0 = (t / sr->tiles_x) * SOFT_TILE;
+        tile.x = (float)x0;
+        tile.y = (float)y0;
+        tile.width = sr->width - x0 < SOFT_TILE ? sr->width - x0 : SOFT_TILE;
+        tile.height = sr->height - y0 < SOFT_TILE ? sr->height - y0 : SOFT_TILE;
+
+        for (int c = 0; c < 3; c++) {
+            const float* source = sr->accumulation + plane * c + (size_t)y0 * sr->width + x0;
+            float* target = scratch + SOFT_TILE_FLOATS * c;
+            for (int y = 0; y < tile.height; y++) {
+                for (int x = 0; x < tile.width; x++) {
+                    float v = source[(size_t)y * sr->width + x] * job->retain;
+                    target[y * SOFT_TILE_STRIDE + x] = v > SOFT_BLACK ? v : 0.0f;
+                }
+            }
+        }
+
+        int first = sr->tile_start[t];
+        sr->raster(&tile, sr->segments, sr->bins + first, sr->tile_start[t + 1] - first);
+
+        for (int c = 0; c < 3; c++) {
+            float* target = sr->accumulation + plane * c + (size_t)y0 * sr->width + x0;
+            const float* source = scratch + SOFT_TILE_FLOATS * c;
+            for (int y = 0; y < tile.height; y++) {
+                memcpy(target + (size_t)y * sr->width, source + y * SOFT_TILE_STRIDE,
+                       sizeof(float) * (size_t)tile.width);
+            }
+        }
+
+        if (job->present) {
+            for (int y = 0; y < tile.height; y++) {
+                int row = y * SOFT_TILE_STRIDE;
+                sr->present(tile.r + row, tile.g + row, tile.b + row,
+                            sr->pixels + (size_t)(y0 + y) * sr->viewport_width + x0, tile.width);
+            }
+        }
+    }
+}
+
+// Present window rows [begin, end) from a scaled accumulation, bilinearly
+// filtered like the GL texture
+static void present_rows_chunk(void* ctx, int begin, int end, int worker) {
+    const SoftDrawJob* job = (const SoftDrawJob*)ctx;
+    const SoftRenderer* sr = job->sr;
+    size_t plane = (size_t)sr->width * sr->height;
+    float* row[3];
+    for (int c = 0; c < 3; c++) {
+        row[c] = sr->scratch + sr->scratch_floats * (size_t)worker + 3 * SOFT_TILE_FLOATS +
+                 (size_t)sr->viewport_width * c;
+    }
+    float step_x = (float)sr->width / (float)sr->viewport_width;
+    float step_y = (float)sr->height / (float)sr->viewport_height;
+
+    for (int y = begin; y < end; y++) {
+        float sy = fminf(fmaxf(((float)y + 0.5f) * step_y - 0.5f, 0.0f), (float)(sr->height - 1));
+        int y0 = (int)sy;
+        int y1 = y0 < sr->height - 1 ? y0 + 1 : y0;
+        float fy = sy - (float)y0;
+
+        for (int x = 0; x < sr->viewport_width; x++) {
+            float sx = fminf(fmaxf(((float)x + 0.5f) * step_x - 0.5f, 0.0f), (float)(sr->width - 1));
+            int x0 = (int)sx;
+            int x1 = x0 < sr->width - 1 ? x0 + 1 : x0;
+            float fx = sx - (float)x0;
+            for (int c = 0; c < 3; c++) {
+                const float* a = sr->accumulation + plane * c;
+                const float* top = a + (size_t)y0 * sr->width;
+                const float* bottom = a + (size_t)y1 * sr->width;
+                float upper = top[x0] + (top[x1] - top[x0]) * fx;
+                float lower = bottom[x0] + (bottom[x1] - bottom[x0]) * fx;
+                row[c][x] = upper + (lower - upper) * fy;
+            }
+        }
+        sr->present(row[0], row[1], row[2], sr->pixels + (size_t)y * sr->viewport_width, sr->viewport_width);
+    }
+}
+
+// Size the accumulation and the tile tables; a new size starts black
+static bool accumulation_reserve(SoftRenderer* sr, int width, int height) {
+    if (sr->accumulation && sr->width == width && sr->height == height) return true;
+
+    int tiles_x = (width + SOFT_TILE - 1) / SOFT_TILE;
+    int tiles_y = (height + SOFT_TILE - 1) / SOFT_TILE;
+    int tiles = tiles_x * tiles_y;
+    float* accumulation = (float*)calloc((size_t)width * height * 3, sizeof(float));
+    if (!accumulation) {
+        fprintf(stderr, "Error: Failed to allocate %dx%d software accumulation\n", width, height);
+        return false;
+    }
+    if (tiles > sr->tile_capacity) {
+        int* tile_start = (int*)malloc(sizeof(int) * (size_t)(tiles + 1));
+        int* group_offset = (int*)malloc(sizeof(int) * (size_t)tiles * sr->workers);
+        if (!tile_start || !group_offset) {
+            fprintf(stderr, "Error: Failed to allocate %d software tiles\n", tiles);
+            free(tile_start);
+            free(group_offset);
+            free(accumulation);
+            return false;
+        }
+        free(sr->tile_start);
+        free(sr->group_offset);
+        sr->tile_start = tile_start;
+        sr->group_offset = group_offset;
+        sr->tile_capacity = tiles;
+    }
+
+    free(sr->accumulation);
+    sr->accumulation = accumulation;
+    sr->width = width;
+    sr->height = height;
+    sr->tiles_x = tiles_x;
+    sr->tiles_y = tiles_y;
+    return true;
+}
+
+SoftRenderer* soft_renderer_create(ThreadPool* pool, int width, int height) {
+    SoftRenderer* sr = (SoftRenderer*)calloc(1, sizeof(SoftRenderer));
+    if (!sr) {
+        fprintf(stderr, "Error: Failed to allocate software renderer\n");
+        return NULL;
+    }
+    sr->pool = pool;
+    sr->workers = pool ? thread_pool_size(pool) : 1;
+    sr->mode = RENDER_LINES;
+
+    sr->raster = SIMD_NAME(soft_raster_tile);
+    sr->present = SIMD_NAME(soft_present);
+#if defined(__x86_64__)
+    if (vector_field_detect_simd() == SIMD_ISA_AVX512) {
+        sr->raster = SIMD_NAME_ISA(soft_raster_tile, avx512);
+        sr->present = SIMD_NAME_ISA(soft_present, avx512);
+    } else if (vector_field_detect_simd() == SIMD_ISA_AVX2) {
+        sr->raster = SIMD_NAME_ISA(soft_raster_tile, avx2);
+        sr->present = SIMD_NAME_ISA(soft_present, avx2);
+    }
+#endif
+
+    // Same 8-bit texels as the GL renderer's colormap texture
+    for (int t = 0; t < COLORMAP_SIZE; t++) {
+        float color[3];
+        particle_color_from_speed((float)t / (COLORMAP_SIZE - 1), color);
+        for (int c = 0; c < 3; c++) sr->colormap[t][c] = (float)(int)(color[c] * 255.0f + 0.5f) / 255.0f;
+    }
+
+    if (!soft_renderer_set_viewport(sr, width, height)) {
+        soft_renderer_destroy(sr);
+        return NULL;
+    }
+    return sr;
+}
+
+bool soft_renderer_begin_particles(SoftRenderer* sr, ParticleSystem* ps, const Config* config,
+                                   const Camera* cam, float alpha, ParticleEmitter* emitter) {
+    if (!sr || !ps || !config || !cam) return false;
+    sr->particle_count = 0;
+    if (ps->count == 0) return false;
+
+    if (ps->count > sr->segment_capacity) {
+        SoftSegment* segments = (SoftSegment*)realloc(sr->segments, sizeof(SoftSegment) * (size_t)ps->count);
+        if (!segments) {
+            fprintf(stderr, "Error: Failed to allocate %d particle segments\n", ps->count);
+            return false;
+        }
+        sr->segments = segments;
+        sr->segment_capacity = ps->count;
+    }
+
+    float left, right, bottom, top;
+    camera_get_view_bounds(cam, &left, &right, &bottom, &top);
+    sr->mode = config->render_mode == RENDER_QUADS ? RENDER_QUADS : RENDER_LINES;
+    sr->alpha = alpha;
+    sr->center_x = (left + right) * 0.5f;
+    sr->center_y = (bottom + top) * 0.5f;
+    sr->scale_x = 1.0f / (right - left);
+    sr->scale_y = 1.0f / (top - bottom);
+    sr->pending_ps = ps;
+
+    if (emitter) {
+        emitter->emit = emit_segments;
+        emitter->ctx = sr;
+    }
+    return true;
+}
+
+void soft_renderer_end_particles(SoftRenderer* sr) {
+    if (!sr || !sr->pending_ps) return;
+    sr->particle_count = sr->pending_ps->count;
+    sr->pending_ps = NULL;
+    sr->in_pixels = false;
+}
+
+void soft_renderer_update_particles(SoftRenderer* sr, ParticleSystem* ps, const Config* config,
+                                    const Camera* cam, float alpha) {
+    if (!soft_renderer_begin_particles(sr, ps, config, cam, alpha, NULL)) return;
+    thread_pool_run(sr->pool, ps->count, SOFT_EMIT_MIN_CHUNK, emit_segments_chunk, sr);
+    soft_renderer_end_particles(sr);
+}
+
+void soft_renderer_draw(SoftRenderer* sr, const Config* config, float frame_time) {
+    if (!sr || sr->particle_count == 0) return;
+
+    float scale = config->render_scale < MIN_RENDER_SCALE ? MIN_RENDER_SCALE
+                : (config->render_scale > 1.0f ? 1.0f : config->render_scale);
+    int width = (int)(sr->viewport_width * scale + 0.5f);
+    int height = (int)(sr->viewport_height * scale + 0.5f);
+    if (!accumulation_reserve(sr, width > 0 ? width : 1, height > 0 ? height : 1)) return;
+
+    frame_time = frame_time < 0.0f ? 0.0f : (frame_time > FADE_MAX_FRAME_TIME ? FADE_MAX_FRAME_TIME : frame_time);
+    float frames = frame_time * FADE_REFERENCE_RATE;  // Reference frames this frame stands for
+    float retain = powf(1.0f - FADE_PER_FRAME, frames);
+    float balance = fade_deposit_balance(frames, retain);
+
+    // Lines are 1.5 window pixels wide, quads particle_size; both measured
+    // in accumulation pixels. Segments cover the path since the last frame,
+    // so their alpha is only balanced against the fade, as the GL
+    // renderer's CPU records.
+    SoftDrawJob job;
+    memset(&job, 0, sizeof(job));
+    job.sr = sr;
+    float width_px = sr->mode == RENDER_QUADS ? config->particle_size * scale
+                                              : (1.5f * scale > 1.0f ? 1.5f * scale : 1.0f);
+    job.style.half_width = 0.5f * width_px;
+    job.style.alpha_head = PARTICLE_ALPHA * balance;
+    job.style.alpha_tail = PARTICLE_ALPHA * 0.5f * balance;
+    job.retain = sr->should_clear ? 0.0f : retain;
+    job.present = width == sr->viewport_width && height == sr->viewport_height;
+    sr->should_clear = false;
+
+    if (!bin_segments(sr, &job)) return;
+    thread_pool_run(sr->pool, sr->tiles_x * sr->tiles_y, 1, draw_tiles_chunk, &job);
+    if (!job.present) {
+        thread_pool_run(sr->pool, sr->viewport_height, SOFT_PRESENT_MIN_ROWS, present_rows_chunk, &job);
+    }
+}
+
+bool soft_renderer_set_viewport(SoftRenderer* sr, int width, int height) {
+    if (!sr) return false;
+    width = width > 0 ? width : 1;
+    height = height > 0 ? height : 1;
+    if (sr->pixels && sr->viewport_width == width && sr->viewport_height == height) return true;
+
+    // Tile planes, then a window row of planes for the scaled present
+    size_t scratch_floats = 3 * (size_t)SOFT_TILE_FLOATS + 3 * (size_t)width;
+    uint32_t* pixels = (uint32_t*)malloc(sizeof(uint32_t) * (size_t)width * height);
+    float* scratch = (float*)calloc(scratch_floats * sr->workers, sizeof(float));
+    if (!pixels || !scratch) {
+        fprintf(stderr, "Error: Failed to allocate %dx%d software framebuffer\n", width, height);
+        free(pixels);
+        free(scratch);
+        return false;
+    }
+
+    // Opaque black until the first frame
+    for (size_t i = 0; i < (size_t)width * height; i++) pixels[i] = 0xff000000u;
+
+    free(sr->pixels);
+    free(sr->scratch);
+    sr->pixels = pixels;
+    sr->scratch = scratch;
+    sr->scratch_floats = scratch_floats;
+    sr->viewport_width = width;
+    sr->viewport_height = height;
+    return true;
+}
+
+void soft_renderer_request_clear(SoftRenderer* sr) {
+    if (sr) {
+        sr->should_clear = true;
+    }
+}
+
+void soft_renderer_destroy(SoftRenderer* sr) {
+    if (sr) {
+        free(sr->segments);
+        free(sr->bins);
+        free(sr->tile_start);
+        free(sr->group_offset);
+        free(sr->accumulation);
+        free(sr->pixels);
+        free(sr->scratch);
+        free(sr);
+    }
+}
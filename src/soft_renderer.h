@@ -0,0 +1,103 @@
+#ifndef SOFT_RENDERER_H
+#define SOFT_RENDERER_H
+
+#include "renderer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Square screen tiles of the rasterizer (pixels)
+#define SOFT_TILE 64
+
+// Floats per tile row in the workers' scratch: vector loops may run up to
+// one SIMD vector (at most 16 lanes) past the tile's right edge
+#define SOFT_TILE_STRIDE (SOFT_TILE + 16)
+
+// One particle segment. Emitted in view units (x right, y down, 0-1
+// across the view); binning converts them to accumulation pixels.
+typedef struct {
+    float ax, ay;      // Tail
+    float bx, by;      // Head
+    float color[3];    // Colormap color of the speed
+    float padding;
+} SoftSegment;
+
+// Tile of the accumulation in a worker's scratch, planar RGB with
+// SOFT_TILE_STRIDE floats per row. Pixel (0, 0) is the tile's top left.
+typedef struct {
+    float* r;
+    float* g;
+    float* b;
+    float x, y;             // Tile origin in accumulation pixels
+    int width, height;      // Pixels of the tile inside the accumulation
+    float half_width;       // Half the segment width (pixels)
+    float alpha_tail, alpha_head;  // Alpha at the ends, times the frame's weight
+} SoftTile;
+
+// Kernels of each ISA (see soft_raster_simd.c)
+typedef void (*SoftRasterFunc)(const SoftTile* tile, const SoftSegment* segments, const int* list, int count);
+typedef void (*SoftPresentFunc)(const float* r, const float* g, const float* b, uint32_t* pixels, int count);
+
+// Tiled CPU rasterizer with the look of the OpenGL renderer: particle
+// segments are drawn as anti-aliased lines (or particle_size wide strips)
+// with additive blending into a float RGB accumulation at render_scale,
+// which fades with the frame time and is tone mapped into `pixels`.
+//
+// Each frame bins the segments into SOFT_TILE tiles on the worker pool;
+// then every tile is faded, rasterized and presented by one worker, so
+// workers never share pixels. Segments land in a tile in emission order,
+// so the image doesn't depend on the thread count.
+typedef struct SoftRenderer {
+    ThreadPool* pool;
+    int workers;                   // Pool size (per-worker scratch)
+    SoftRasterFunc raster;         // Widest kernels the CPU runs
+    SoftPresentFunc present;
+
+    // Current frame's segments, written between begin and end
+    SoftSegment* segments;
+    int segment_capacity;
+    int particle_count;            // Segments in the current frame
+    ParticleSystem* pending_ps;    // Particles being written (between begin and end)
+    bool in_pixels;                // Binning has converted the current segments to pixels
+    RenderMode mode;
+    float alpha;                   // Render time between the previous and current step
+    float center_x, center_y;      // View center
+    float scale_x, scale_y;        // View units per world unit
+    float colormap[COLORMAP_SIZE][3];  // As the GL renderer's texture
+
+    // Tile bins: segment indices of tile t are bins[tile_start[t]] up to
+    // bins[tile_start[t + 1]]
+    int tiles_x, tiles_y;
+    int* bins;
+    int bin_capacity;
+    int* tile_start;               // tiles + 1 entries
+    int* group_offset;             // Binning: workers x tiles counts, then write positions
+    int tile_capacity;
+
+    // Accumulation (planar RGB, width * height floats each) and the window
+    // image (BGRA8, top row first)
+    float* accumulation;
+    int width, height;
+    uint32_t* pixels;
+    int viewport_width, viewport_height;
+    float* scratch;                // Per worker: tile planes, then one window row of planes
+    size_t scratch_floats;         // Per worker
+    bool should_clear;
+} SoftRenderer;
+
+// NULL if the buffers can't be allocated
+SoftRenderer* soft_renderer_create(ThreadPool* pool, int width, int height);
+// Same contract as renderer_begin_particles / renderer_end_particles
+bool soft_renderer_begin_particles(SoftRenderer* sr, ParticleSystem* ps, const Config* config,
+                                   const Camera* cam, float alpha, ParticleEmitter* emitter);
+void soft_renderer_end_particles(SoftRenderer* sr);
+void soft_renderer_update_particles(SoftRenderer* sr, ParticleSystem* ps, const Config* config,
+                                    const Camera* cam, float alpha);
+// frame_time: wall time since the previous frame (seconds), drives the fade
+void soft_renderer_draw(SoftRenderer* sr, const Config* config, float frame_time);
+// Reallocates `pixels`; false (keeping the old size) if that fails
+bool soft_renderer_set_viewport(SoftRenderer* sr, int width, int height);
+void soft_renderer_request_clear(SoftRenderer* sr);
+void soft_renderer_destroy(SoftRenderer* sr);
+
+#endif // SOFT_RENDERER_H
@@ -0,0 +1,155 @@
+#define _POSIX_C_SOURCE 200112L  // sysconf
+
+#include "thread_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Chunks handed out per thread; >1 evens out imbalance between chunks
+#define CHUNKS_PER_THREAD 4
+
+// Claim and run chunks of the current job until none are left
+static void thread_pool_work(ThreadPool* pool, int worker) {
+    for (;;) {
+        int begin = __atomic_fetch_add(&pool->next, pool->chunk, __ATOMIC_RELAXED);
+        if (begin >= pool->count) break;
+
+        int end = begin + pool->chunk;
+        if (end > pool->count) end = pool->count;
+        pool->task(pool->ctx, begin, end, worker);
+    }
+}
+
+typedef struct {
+    ThreadPool* pool;
+    int worker;
+} WorkerArgs;
+
+static void* thread_pool_worker(void* arg) {
+    WorkerArgs args = *(WorkerArgs*)arg;
+    free(arg);
+
+    ThreadPool* pool = args.pool;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        // Park until a new job (or shutdown) is published
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->job_ready, &pool->mutex);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        thread_pool_work(pool, args.worker);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->job_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+ThreadPool* thread_pool_create(int thread_count) {
+    if (thread_count <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cpus > 0 ? (int)cpus : 1;
+    }
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) {
+        fprintf(stderr, "Error: Failed to allocate thread pool\n");
+        return NULL;
+    }
+
+    pool->threads = (pthread_t*)calloc(thread_count, sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        fprintf(stderr, "Error: Failed to allocate thread pool\n");
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->job_ready, NULL);
+    pthread_cond_init(&pool->job_done, NULL);
+    pool->thread_count = 1;
+
+    // Worker 0 is the calling thread
+    for (int i = 1; i < thread_count; i++) {
+        WorkerArgs* args = (WorkerArgs*)malloc(sizeof(WorkerArgs));
+        if (!args) break;
+        args->pool = pool;
+        args->worker = i;
+
+        if (pthread_create(&pool->threads[i], NULL, thread_pool_worker, args) != 0) {
+            free(args);
+            fprintf(stderr, "Warning: Failed to start worker thread %d\n", i);
+            break;
+        }
+        pool->thread_count++;
+    }
+
+    printf("Thread pool: %d threads\n", pool->thread_count);
+    return pool;
+}
+
+void thread_pool_run(ThreadPool* pool, int count, int min_chunk, ThreadPoolTask task, void* ctx) {
+    if (count <= 0) return;
+
+    if (!pool || pool->thread_count == 1 || count <= min_chunk) {
+        task(ctx, 0, count, 0);
+        return;
+    }
+
+    // Aligned chunks, small enough to balance but at least min_chunk
+    int chunk = count / (pool->thread_count * CHUNKS_PER_THREAD);
+    if (chunk < min_chunk) chunk = min_chunk;
+    chunk = (chunk + THREAD_POOL_CHUNK_ALIGN - 1) & ~(THREAD_POOL_CHUNK_ALIGN - 1);
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->chunk = chunk;
+    pool->next = 0;
+    pool->active = pool->thread_count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->mutex);
+
+    thread_pool_work(pool, 0);
+
+    // Workers may still be finishing their last chunk
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->job_done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+int thread_pool_size(const ThreadPool* pool) {
+    return pool ? pool->thread_count : 1;
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 1; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->job_ready);
+    pthread_cond_destroy(&pool->job_done);
+    free(pool->threads);
+    free(pool);
+}
@@ -0,0 +1,46 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+// Chunk boundaries are multiples of this many elements, so chunks of float
+// arrays aligned to 64 bytes never share a cache line
+#define THREAD_POOL_CHUNK_ALIGN 16
+
+// Work item: process elements [begin, end). `worker` is in [0, pool size)
+// and identifies the calling thread (for per-worker scratch data).
+typedef void (*ThreadPoolTask)(void* ctx, int begin, int end, int worker);
+
+// Persistent worker pool. Workers are parked on a condition variable
+// between jobs; the calling thread takes part as worker 0.
+typedef struct {
+    pthread_t* threads;
+    int thread_count;        // Worker threads + the calling thread
+
+    pthread_mutex_t mutex;
+    pthread_cond_t job_ready;
+    pthread_cond_t job_done;
+    unsigned long generation;  // Bumped for every job
+    int active;                // Workers still inside the current job
+    bool shutdown;
+
+    // Current job
+    ThreadPoolTask task;
+    void* ctx;
+    int count;
+    int chunk;
+    int next;                  // Next unclaimed element (atomic)
+} ThreadPool;
+
+// thread_count <= 0 picks one thread per online CPU
+ThreadPool* thread_pool_create(int thread_count);
+
+// Run task over [0, count) in chunks of at least min_chunk elements and
+// wait for completion. A NULL pool runs the task inline.
+void thread_pool_run(ThreadPool* pool, int count, int min_chunk, ThreadPoolTask task, void* ctx);
+
+int thread_pool_size(const ThreadPool* pool);
+void thread_pool_destroy(ThreadPool* pool);
+
+#endif // THREAD_POOL_H
@@ -1,4 +1,5 @@
 #include "vector_field.h"
+#include "field_cache.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -16,6 +17,8 @@
 
 typedef struct {
     VectorFieldFunc func;
+    VectorFieldBatchFunc batch;
+    VectorFieldBatchFunc simd[MATH_PRECISION_COUNT][SIMD_ISA_COUNT];
     char name[64];
     bool registered;
 } FieldEntry;
@@ -80,15 +83,34 @@ void vector_field_register(int index, VectorFieldFunc func, const char* name) {
     }
 }
 
-VectorFieldFunc vector_field_get(int index) {
+// Batch kernels register independently of (and possibly before) the field
+void vector_field_register_batch(int index, VectorFieldBatchFunc batch) {
+    if (index >= 0 && index < MAX_FIELDS) {
+        field_registry[index].batch = batch;
+    } else {
+        fprintf(stderr, "Warning: Field index %d out of range (max: %d)\n", index, MAX_FIELDS);
+    }
+}
+
+void vector_field_register_simd(int index, int isa, MathPrecision precision, VectorFieldBatchFunc batch) {
+    if (index >= 0 && index < MAX_FIELDS && isa >= 0 && isa < SIMD_ISA_COUNT &&
+        precision >= 0 && precision < MATH_PRECISION_COUNT) {
+        field_registry[index].simd[precision][isa] = batch;
+    } else {
+        fprintf(stderr, "Warning: Field index %d / SIMD ISA %d / precision %d out of range\n",
+                index, isa, precision);
+    }
+}
+
+static const FieldEntry* vector_field_get_entry(int index) {
     if (index >= 0 && index < MAX_FIELDS && field_registry[index].registered) {
-        return field_registry[index].func;
+        return &field_registry[index];
     }
     
     // Fallback: find first registered field
     for (int i = 0; i < MAX_FIELDS; i++) {
         if (field_registry[i].registered) {
-            return field_registry[i].func;
+            return &field_registry[i];
         }
     }
     
@@ -96,6 +118,11 @@ VectorFieldFunc vector_field_get(int index) {
     return NULL;
 }
 
+VectorFieldFunc vector_field_get(int index) {
+    const FieldEntry* entry = vector_field_get_entry(index);
+    return entry ? entry->func : NULL;
+}
+
 const char* vector_field_get_name(int index) {
     if (index >= 0 && index < MAX_FIELDS && field_registry[index].registered) {
         return field_registry[index].name;
@@ -134,4 +161,81 @@ vec2 vector_field_evaluate(vec2 p, const Config* config) {
         return func(p, config->field_scale);
     }
     return vec2_create(0.0f, 0.0f);
-}
\ No newline at end of file
+}
+
+// =============================================================================
+// SIMD Dispatch
+// =============================================================================
+
+static int simd_isa = -1;
+
+// CPUID-based; __builtin_cpu_supports also checks that the OS saves the
+// wide register state (XGETBV), so a listed ISA is safe to execute
+int vector_field_detect_simd(void) {
+    if (simd_isa >= 0) return simd_isa;
+    
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        simd_isa = SIMD_ISA_AVX512;
+    } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        simd_isa = SIMD_ISA_AVX2;
+    } else {
+        simd_isa = SIMD_ISA_SSE2;
+    }
+#else
+    simd_isa = SIMD_ISA_NONE;
+#endif
+    return simd_isa;
+}
+
+const char* vector_field_simd_name(int isa) {
+    switch (isa) {
+        case SIMD_ISA_SSE2:   return "SSE2 (4-wide)";
+        case SIMD_ISA_AVX2:   return "AVX2 (8-wide)";
+        case SIMD_ISA_AVX512: return "AVX-512 (16-wide)";
+        default:              return "scalar";
+    }
+}
+
+// =============================================================================
+// Batched Evaluation
+// =============================================================================
+
+VectorFieldEvaluator vector_field_resolve(const Config* config) {
+    VectorFieldEvaluator eval = {NULL, NULL, config->field_scale, NULL};
+    const FieldEntry* entry = vector_field_get_entry(config->vector_field_num);
+    if (entry) {
+        eval.func = entry->func;
+        eval.batch = entry->batch;
+        
+        // Widest SIMD kernel the CPU can run, at the configured precision
+        for (int isa = vector_field_detect_simd(); isa >= SIMD_ISA_NONE; isa--) {
+            if (entry->simd[config->math_precision][isa]) {
+                eval.batch = entry->simd[config->math_precision][isa];
+                break;
+            }
+        }
+    }
+    return eval;
+}
+
+void vector_field_evaluate_batch(const VectorFieldEvaluator* eval, const float* x, const float* y,
+                                 float* vx, float* vy, int n) {
+    if (eval->cache) {
+        field_cache_evaluate(eval->cache, x, y, vx, vy, n);
+        return;
+    }
+    
+    if (eval->batch) {
+        eval->batch(x, y, vx, vy, n, eval->scale);
+        return;
+    }
+    
+    // Generic fallback: loop over the scalar function
+    for (int i = 0; i < n; i++) {
+        vec2 v = eval->func ? eval->func(vec2_create(x[i], y[i]), eval->scale) : vec2_create(0.0f, 0.0f);
+        vx[i] = v.x;
+        vy[i] = v.y;
+    }
+}
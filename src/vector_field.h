@@ -14,6 +14,26 @@ typedef struct {
 // Function pointer type for vector fields
 typedef vec2 (*VectorFieldFunc)(vec2 p, float scale);
 
+// Batched evaluation: (vx[i], vy[i]) = field((x[i], y[i])) for i in [0, n)
+typedef void (*VectorFieldBatchFunc)(const float* x, const float* y, float* vx, float* vy, int n, float scale);
+
+// SIMD instruction sets with field kernels, narrowest to widest
+#define SIMD_ISA_NONE   0   // Plain C batch kernels
+#define SIMD_ISA_SSE2   1   // 4-wide (x86-64 baseline)
+#define SIMD_ISA_AVX2   2   // 8-wide, AVX2 + FMA
+#define SIMD_ISA_AVX512 3   // 16-wide, AVX-512F
+#define SIMD_ISA_COUNT  4
+
+struct FieldCache;
+
+// Field resolved once (e.g. per frame) for repeated batch evaluation
+typedef struct {
+    VectorFieldFunc func;        // Scalar evaluation
+    VectorFieldBatchFunc batch;  // Batched evaluation (NULL = loop over func)
+    float scale;
+    const struct FieldCache* cache;  // Interpolate cached samples instead (NULL = exact)
+} VectorFieldEvaluator;
+
 // Vector utility functions
 vec2 vec2_create(float x, float y);
 vec2 vec2_add(vec2 a, vec2 b);
@@ -25,6 +45,8 @@ vec2 vec2_normalize(vec2 v);
 
 // Field registration system
 void vector_field_register(int index, VectorFieldFunc func, const char* name);
+void vector_field_register_batch(int index, VectorFieldBatchFunc batch);
+void vector_field_register_simd(int index, int isa, MathPrecision precision, VectorFieldBatchFunc batch);
 VectorFieldFunc vector_field_get(int index);
 const char* vector_field_get_name(int index);
 int vector_field_get_count();
@@ -34,4 +56,13 @@ void vector_field_list_all();
 vec2 get_velocity(vec2 p, int field_type, float scale);
 vec2 vector_field_evaluate(vec2 p, const Config* config);
 
+// SIMD dispatch (widest ISA supported by the CPU, detected once)
+int vector_field_detect_simd(void);
+const char* vector_field_simd_name(int isa);
+
+// Batched evaluation
+VectorFieldEvaluator vector_field_resolve(const Config* config);
+void vector_field_evaluate_batch(const VectorFieldEvaluator* eval, const float* x, const float* y,
+                                 float* vx, float* vy, int n);
+
 #endif // VECTOR_FIELD_H
\ No newline at end of file
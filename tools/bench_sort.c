@@ -0,0 +1,152 @@
+// Effect of particle_system_sort on memory locality (make bench-sort).
+//
+// 200k particles, one worker, field 3. For each field_cache mode it times
+// particle_system_update with the periodic sort off and on, at the default
+// simulation_speed and at 50, where particles outrun the sort. With
+// field_cache = off the update loop only streams its arrays and evaluates
+// the field analytically: it has no position-indexed reads, so sorting
+// can't speed it up, and the update doesn't sort then. The field cache
+// reads its tiles by position, which is where the order shows.
+//
+// There are no hardware counters to read here, so cache misses are
+// approximated by a nearest-sample lookup into a 512x512 float2 table
+// (2 MB, like a field cache) at each particle's position: the fraction of
+// particles whose sample lies in a different cache line than their
+// predecessor's is the fraction of lookups that can't hit the line just
+// loaded.
+
+#define _POSIX_C_SOURCE 199309L
+#include "particles.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_PARTICLES 200000
+#define BENCH_WARMUP_STEPS 300
+#define BENCH_STEPS 200
+#define BENCH_TABLE 512
+#define BENCH_LOOKUP_RUNS 20
+
+static float table[BENCH_TABLE * BENCH_TABLE * 2];
+static volatile double sink;  // Keeps the table reads alive
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Table lookup of every particle; *new_lines counts lookups in a different
+// cache line than the previous one
+static double table_lookup(const ParticleSystem* ps, const Camera* cam, long* new_lines) {
+    float left, right, bottom, top;
+    camera_get_view_bounds(cam, &left, &right, &bottom, &top);
+    float sx = BENCH_TABLE / (right - left);
+    float sy = BENCH_TABLE / (top - bottom);
+
+    double sum = 0.0;
+    long previous = -1;
+    *new_lines = 0;
+    for (int i = 0; i < ps->count; i++) {
+        int x = (int)((ps->x[i] - left) * sx);
+        int y = (int)((ps->y[i] - bottom) * sy);
+        x = x < 0 ? 0 : (x >= BENCH_TABLE ? BENCH_TABLE - 1 : x);
+        y = y < 0 ? 0 : (y >= BENCH_TABLE ? BENCH_TABLE - 1 : y);
+        long sample = (long)y * BENCH_TABLE + x;
+        sum += table[2 * sample] + table[2 * sample + 1];
+
+        long line = sample * 2 * (long)sizeof(float) / 64;
+        if (line != previous) (*new_lines)++;
+        previous = line;
+    }
+    return sum;
+}
+
+static void report_lookup(const char* label, const ParticleSystem* ps, const Camera* cam) {
+    long new_lines = 0;
+    double start = now_seconds();
+    for (int run = 0; run < BENCH_LOOKUP_RUNS; run++) sink += table_lookup(ps, cam, &new_lines);
+    double seconds = (now_seconds() - start) / BENCH_LOOKUP_RUNS;
+    printf("  %-16s %5.1f ns/particle, new cache line for %3.0f%% (disorder %.2f)\n", label,
+           seconds * 1e9 / ps->count, 100.0 * new_lines / ps->count, ps->occupancy.disorder);
+}
+
+// Average update time over BENCH_STEPS after warming up; *sorts counts
+// the sorts among them
+static double time_update(ParticleSystem* ps, const Config* config, const Camera* cam, int* sorts) {
+    for (int step = 0; step < BENCH_WARMUP_STEPS; step++) {
+        particle_system_update(ps, config, cam, 1.0f / 60.0f);
+    }
+    *sorts = 0;
+    double start = now_seconds();
+    for (int step = 0; step < BENCH_STEPS; step++) {
+        unsigned int last_sort = ps->sort.last_frame;
+        particle_system_update(ps, config, cam, 1.0f / 60.0f);
+        if (ps->sort.last_frame != last_sort) (*sorts)++;
+    }
+    return (now_seconds() - start) / BENCH_STEPS;
+}
+
+int main(void) {
+    for (int i = 0; i < BENCH_TABLE * BENCH_TABLE * 2; i++) table[i] = (float)i * 1e-9f;
+
+    ThreadPool* pool = thread_pool_create(1);
+    Camera cam = camera_create();
+    Config config = config_create_default();
+    config.vector_field_num = 3;
+    config.field_scale = 1.5f;
+    config.particle_lifetime = 30.0f;
+
+    // Default speed, then fast enough that the disorder trigger sorts
+    // every few steps
+    float speeds[] = { 1.0f, 50.0f };
+    FieldCacheMode modes[] = { FIELD_CACHE_OFF, FIELD_CACHE_BILINEAR };
+    for (int k = 0; k < 4; k++) {
+        config.simulation_speed = speeds[k / 2];
+        config.field_cache = modes[k % 2];
+        if (k % 2 == 0) printf("Update step, %d particles, simulation_speed %g:\n", BENCH_PARTICLES, speeds[k / 2]);
+        double ms[2];
+        int sorts[2];
+        for (int sorted = 0; sorted < 2; sorted++) {
+            config.sort_interval = sorted ? 120 : 0;
+            ParticleSystem* ps = particle_system_create(BENCH_PARTICLES, 99, pool);
+            if (!ps) {
+                fprintf(stderr, "Error: Failed to create particle system\n");
+                return 1;
+            }
+            particle_system_redistribute(ps, &config, &cam);
+            ms[sorted] = time_update(ps, &config, &cam, &sorts[sorted]) * 1e3;
+            particle_system_destroy(ps);
+        }
+        printf("  field_cache = %-8s unsorted %.2f ms, sorted %.2f ms (%d sorts in %d steps)\n",
+               config_field_cache_name(config.field_cache), ms[0], ms[1], sorts[1], BENCH_STEPS);
+    }
+
+    printf("Position-indexed table lookup (%d MB), simulation_speed 1:\n", (int)(sizeof(table) >> 20));
+    config.simulation_speed = 1.0f;
+    config.field_cache = FIELD_CACHE_OFF;
+    config.sort_interval = 0;
+    ParticleSystem* ps = particle_system_create(BENCH_PARTICLES, 99, pool);
+    if (!ps) {
+        fprintf(stderr, "Error: Failed to create particle system\n");
+        return 1;
+    }
+    particle_system_redistribute(ps, &config, &cam);
+    for (int step = 0; step < BENCH_WARMUP_STEPS; step++) particle_system_update(ps, &config, &cam, 1.0f / 60.0f);
+    report_lookup("unsorted", ps, &cam);
+
+    double start = now_seconds();
+    particle_system_sort(ps, &cam);
+    double sort_ms = (now_seconds() - start) * 1e3;
+    particle_system_update(ps, &config, &cam, 1.0f / 60.0f);  // Refresh the disorder
+    report_lookup("just sorted", ps, &cam);
+
+    for (int step = 1; step < 120; step++) particle_system_update(ps, &config, &cam, 1.0f / 60.0f);
+    report_lookup("120 steps later", ps, &cam);
+    printf("Sort: %.2f ms\n", sort_ms);
+
+    particle_system_destroy(ps);
+    thread_pool_destroy(pool);
+    return 0;
+}
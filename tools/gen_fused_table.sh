@@ -0,0 +1,33 @@
+#!/bin/sh
+# Generates the fused integrator x field dispatch table (integrator_fused_table)
+# from the REGISTER_FIELD_SIMD lines of the given field sources. Run by the
+# Makefile; the output goes to build/gen/fused_table.c.
+#
+# Usage: tools/gen_fused_table.sh src/fields/*.c > build/gen/fused_table.c
+
+set -e
+
+fields=$(sed -n 's/^REGISTER_FIELD_SIMD( *\([0-9][0-9]*\) *, *\([A-Za-z_][A-Za-z0-9_]*\) *);.*/\1 \2/p' "$@" | sort -n)
+
+if [ -z "$fields" ]; then
+    echo "gen_fused_table.sh: no REGISTER_FIELD_SIMD found in: $*" >&2
+    exit 1
+fi
+
+echo "// Generated by tools/gen_fused_table.sh - do not edit"
+echo "#include \"field_common.h\""
+echo
+
+echo "$fields" | while read -r idx name; do
+    echo "FIELD_FUSED_DECLARE($name)"
+done
+
+echo
+echo "const IntegratorFusedFunc integrator_fused_table[][INTEGRATOR_COUNT][MATH_PRECISION_COUNT][SIMD_ISA_COUNT] = {"
+echo "$fields" | while read -r idx name; do
+    echo "    FIELD_FUSED_ENTRIES($idx, $name)"
+done
+echo "};"
+echo
+echo "const int integrator_fused_table_size ="
+echo "    (int)(sizeof(integrator_fused_table) / sizeof(integrator_fused_table[0]));"
@@ -0,0 +1,141 @@
+// GPU simulation against the CPU path (make check-gpu).
+//
+// Runs headless, like --headless: an EGL context on Mesa's surfaceless
+// platform (llvmpipe without a GPU). For each backend the context has
+// (compute shaders on GL 4.3, transform feedback always) and each field
+// ported to shaders/fields.glsl, the CPU particles are uploaded with
+// gpu_particles_upload, both sides run GPU_CHECK_STEPS RK4 steps, and
+// gpu_particles_download brings the GPU positions back. Particles that
+// respawned on either side are skipped: respawns draw different random
+// numbers (the CPU path is density controlled).
+//
+// The CPU runs without any approximation the GPU lacks (reference math,
+// no field cache, flow map, multirate or sort), so what is left is float
+// rounding and the GLSL functions' accuracy.
+
+#include "gpu_particles.h"
+#include "headless.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define GPU_CHECK_PARTICLES 20000
+#define GPU_CHECK_STEPS 120
+#define GPU_CHECK_SPEED 40.0f
+
+// Largest position error allowed (world units, the default view is 2
+// wide). llvmpipe reaches 9.3e-5 on the fastest fields.
+#define GPU_CHECK_MAX_ERROR 1e-4
+
+static int compare_floats(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Run one field on both sides; returns false if the error bound fails
+static bool check_field(bool feedback, int field, ThreadPool* pool, const Camera* cam) {
+    Config config = config_create_default();
+    config.vector_field_num = field;
+    config.integrator = INTEGRATOR_RK4;
+    config.math_precision = MATH_PRECISION_REFERENCE;
+    config.field_cache = FIELD_CACHE_OFF;
+    config.flow_map = false;
+    config.multirate_interval = 1;
+    config.sort_interval = 0;
+    config.simulation_speed = GPU_CHECK_SPEED;
+    config.particle_lifetime = 1e9f;
+
+    ParticleSystem* ps = particle_system_create(GPU_CHECK_PARTICLES, 1234, pool);
+    ParticleSystem* result = particle_system_create(GPU_CHECK_PARTICLES, 1234, pool);
+    GpuParticles* gp = gpu_particles_create(GPU_CHECK_PARTICLES, 1234, feedback);
+    float* errors = (float*)malloc(sizeof(float) * GPU_CHECK_PARTICLES);
+    if (!ps || !result || !gp || !errors) {
+        fprintf(stderr, "Error: Failed to set up the GPU check\n");
+        particle_system_destroy(ps);
+        particle_system_destroy(result);
+        gpu_particles_destroy(gp);
+        free(errors);
+        return false;
+    }
+
+    // Ages start at 0 and stay far below the lifetime: a particle whose age
+    // isn't a sum of steps has respawned
+    particle_system_redistribute_grid(ps, &config, cam);
+    for (int i = 0; i < ps->count; i++) ps->lifetime[i] = 0.0f;
+    gpu_particles_upload(gp, ps);
+
+    float dt = 1.0f / config.simulation_rate;
+    for (int step = 0; step < GPU_CHECK_STEPS; step++) {
+        particle_system_update(ps, &config, cam, dt);
+        gpu_particles_update(gp, &config, cam, dt);
+    }
+    gpu_particles_download(gp, result);
+
+    float age = (float)GPU_CHECK_STEPS * dt * 1.5f;
+    int compared = 0;
+    for (int i = 0; i < ps->count; i++) {
+        if (ps->lifetime[i] > age || result->lifetime[i] > age) continue;
+        errors[compared++] = hypotf(ps->x[i] - result->x[i], ps->y[i] - result->y[i]);
+    }
+
+    bool ok = compared > 0;
+    if (ok) {
+        qsort(errors, (size_t)compared, sizeof(float), compare_floats);
+        ok = errors[compared - 1] <= GPU_CHECK_MAX_ERROR;
+        printf("  field %d %-24s %5d compared, error median %.2g, max %.2g %s\n", field + 1,
+               vector_field_get_name(field), compared, errors[compared / 2], errors[compared - 1],
+               ok ? "ok" : "FAIL");
+    } else {
+        printf("  field %d %-24s every particle respawned FAIL\n", field + 1, vector_field_get_name(field));
+    }
+
+    particle_system_destroy(ps);
+    particle_system_destroy(result);
+    gpu_particles_destroy(gp);
+    free(errors);
+    return ok;
+}
+
+int main(void) {
+    HeadlessContext* headless = headless_create(64, 64);
+    if (!headless) {
+        fprintf(stderr, "Error: No headless OpenGL context\n");
+        return 1;
+    }
+
+    ThreadPool* pool = thread_pool_create(0);
+    Camera cam = camera_create();
+    int failures = 0;
+    int backends = 0;
+
+    for (int feedback = 0; feedback <= 1; feedback++) {
+        // Compute shaders fall back to transform feedback below GL 4.3
+        GpuParticles* probe = gpu_particles_create(1, 1, feedback);
+        bool available = probe && probe->feedback == (bool)feedback;
+        gpu_particles_destroy(probe);
+        if (!available) continue;
+
+        backends++;
+        printf("%s, %d particles, %d RK4 steps at speed %g (error bound %g):\n",
+               feedback ? "Transform feedback" : "Compute shaders", GPU_CHECK_PARTICLES, GPU_CHECK_STEPS,
+               GPU_CHECK_SPEED, GPU_CHECK_MAX_ERROR);
+        for (int field = 0; field < GPU_FIELD_COUNT; field++) {
+            if (!check_field(feedback, field, pool, &cam)) failures++;
+        }
+    }
+
+    thread_pool_destroy(pool);
+    headless_destroy(headless);
+
+    if (backends == 0) {
+        fprintf(stderr, "Error: No GPU simulation backend available\n");
+        return 1;
+    }
+    if (failures > 0) {
+        fprintf(stderr, "Error: %d fields differ from the CPU path\n", failures);
+        return 1;
+    }
+    printf("GPU simulation matches the CPU path\n");
+    return 0;
+}
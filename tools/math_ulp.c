@@ -0,0 +1,194 @@
+// Accuracy check of the simd_math.h tiers against libm (make check-math).
+// Like the field kernels, this file is compiled once more per wide ISA;
+// main, in the baseline object, runs every ISA the CPU supports over the
+// domains the fields feed in and fails if an error exceeds its bound.
+
+#include "simd_math.h"
+
+#include <stdio.h>
+
+// Functions checked, in report order
+enum { MATH_SIN, MATH_COS, MATH_EXP, MATH_ATAN2, MATH_SQRT, MATH_RCP, MATH_FUNC_COUNT };
+
+// Worst error of one function over its domain
+typedef struct {
+    double ulp;   // Against libm (double) rounded to float
+    double abs;
+    double rel;
+} MathError;
+
+typedef void (*MathMeasureFunc)(MathPrecision prec, MathError errors[MATH_FUNC_COUNT]);
+
+// atan2 is sampled on a MATH_GRID x MATH_GRID grid, the others at
+// MATH_GRID^2 evenly spaced points
+#define MATH_GRID 1024
+
+// Distance in representable floats between a and b
+static inline double math_ulp_distance(float a, float b) {
+    int32_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    // Map the sign-magnitude bit patterns onto one ordered integer line
+    int64_t oa = ia < 0 ? (int64_t)INT32_MIN - ia : ia;
+    int64_t ob = ib < 0 ? (int64_t)INT32_MIN - ib : ib;
+    return (double)(oa > ob ? oa - ob : ob - oa);
+}
+
+static inline void math_error_add(MathError* e, float got, double want) {
+    double ulp = math_ulp_distance(got, (float)want);
+    double abs = fabs((double)got - want);
+    double rel = want != 0.0 ? abs / fabs(want) : abs;
+    if (ulp > e->ulp) e->ulp = ulp;
+    if (abs > e->abs) e->abs = abs;
+    if (rel > e->rel) e->rel = rel;
+}
+
+// Point i of n spread evenly over [lo, hi], or (lo, hi] when open
+static inline float math_sample(int i, int n, float lo, float hi, bool open) {
+    return open ? lo + (hi - lo) * (float)(i + 1) / (float)n
+                : lo + (hi - lo) * (float)i / (float)(n - 1);
+}
+
+void SIMD_NAME(math_measure)(MathPrecision prec, MathError errors[MATH_FUNC_COUNT]) {
+    const int n = MATH_GRID * MATH_GRID;
+    float in[SIMD_WIDTH], in2[SIMD_WIDTH], out[SIMD_WIDTH], out2[SIMD_WIDTH];
+    memset(errors, 0, sizeof(MathError) * MATH_FUNC_COUNT);
+
+    // n is a multiple of every SIMD_WIDTH, so there is no tail
+    for (int i = 0; i < n; i += SIMD_WIDTH) {
+        for (int k = 0; k < SIMD_WIDTH; k++) in[k] = math_sample(i + k, n, -200.0f, 200.0f, false);
+        vf s, c;
+        vm_sincos(vf_load(in), prec, &s, &c);
+        vf_store(out, s);
+        vf_store(out2, c);
+        for (int k = 0; k < SIMD_WIDTH; k++) {
+            math_error_add(&errors[MATH_SIN], out[k], sin((double)in[k]));
+            math_error_add(&errors[MATH_COS], out2[k], cos((double)in[k]));
+        }
+
+        for (int k = 0; k < SIMD_WIDTH; k++) in[k] = math_sample(i + k, n, -6.0f, 0.0f, false);
+        vf_store(out, vm_exp(vf_load(in), prec));
+        for (int k = 0; k < SIMD_WIDTH; k++) math_error_add(&errors[MATH_EXP], out[k], exp((double)in[k]));
+
+        for (int k = 0; k < SIMD_WIDTH; k++) in[k] = math_sample(i + k, n, 0.0f, 300.0f, true);
+        vf_store(out, vm_sqrt(vf_load(in), prec));
+        vf_store(out2, vm_rcp(vf_load(in), prec));
+        for (int k = 0; k < SIMD_WIDTH; k++) {
+            math_error_add(&errors[MATH_SQRT], out[k], sqrt((double)in[k]));
+            math_error_add(&errors[MATH_RCP], out2[k], 1.0 / (double)in[k]);
+        }
+
+        for (int k = 0; k < SIMD_WIDTH; k++) {
+            in[k] = math_sample((i + k) % MATH_GRID, MATH_GRID, -12.0f, 12.0f, false);
+            in2[k] = math_sample((i + k) / MATH_GRID, MATH_GRID, -12.0f, 12.0f, false);
+        }
+        vf_store(out, vm_atan2(vf_load(in2), vf_load(in), prec));
+        for (int k = 0; k < SIMD_WIDTH; k++) {
+            math_error_add(&errors[MATH_ATAN2], out[k], atan2((double)in2[k], (double)in[k]));
+        }
+    }
+}
+
+#ifndef FIELD_SIMD_VARIANT
+
+// Measurements of each ISA (math_ulp.c)
+#define MATH_DECLARE_MEASURE(suffix) \
+    void SIMD_NAME_ISA(math_measure, suffix)(MathPrecision prec, MathError errors[MATH_FUNC_COUNT]);
+
+MATH_DECLARE_MEASURE(SIMD_SUFFIX)
+#if defined(__x86_64__)
+MATH_DECLARE_MEASURE(avx2)
+MATH_DECLARE_MEASURE(avx512)
+#endif
+
+// Which error a bound applies to
+typedef enum { BOUND_ULP, BOUND_ABS, BOUND_REL } BoundKind;
+
+typedef struct {
+    BoundKind kind;
+    double limit;
+} MathBound;
+
+static const char* func_names[MATH_FUNC_COUNT] = { "sin", "cos", "exp", "atan2", "sqrt", "rcp" };
+static const char* bound_names[] = { "ulp", "abs", "rel" };
+
+// Documented accuracy of each tier (see simd_math.h). The visual tier is
+// bounded in absolute or relative terms: near a zero of sin/cos or atan2
+// any absolute error is a large ulp count. Its sin/cos reach 1.6e-5 with
+// FMA; SSE2 rounds q * pi/2 in the reduction, which adds ~0.5e-5.
+static const MathBound bounds[MATH_PRECISION_COUNT][MATH_FUNC_COUNT] = {
+    [MATH_PRECISION_VISUAL] = {
+        [MATH_SIN]   = { BOUND_ABS, 2.1e-5 },
+        [MATH_COS]   = { BOUND_ABS, 2.1e-5 },
+        [MATH_EXP]   = { BOUND_REL, 7.5e-5 },
+        [MATH_ATAN2] = { BOUND_ABS, 1.1e-4 },
+        [MATH_SQRT]  = { BOUND_REL, 6e-5 },
+        [MATH_RCP]   = { BOUND_REL, 6e-5 },
+    },
+    [MATH_PRECISION_REFERENCE] = {
+        [MATH_SIN]   = { BOUND_ULP, 2 },
+        [MATH_COS]   = { BOUND_ULP, 2 },
+        [MATH_EXP]   = { BOUND_ULP, 1 },
+        [MATH_ATAN2] = { BOUND_ULP, 4 },
+        [MATH_SQRT]  = { BOUND_ULP, 0 },
+        [MATH_RCP]   = { BOUND_ULP, 0 },
+    },
+};
+
+// Widest ISA the CPU runs, as vector_field_detect_simd
+static int detect_isa(void) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SIMD_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SIMD_ISA_AVX2;
+    return SIMD_ISA_SSE2;
+#else
+    return SIMD_ISA_NONE;
+#endif
+}
+
+static const char* isa_names[SIMD_ISA_COUNT] = { "scalar", "sse2", "avx2", "avx512" };
+
+static double error_of(const MathError* e, BoundKind kind) {
+    switch (kind) {
+        case BOUND_ULP: return e->ulp;
+        case BOUND_ABS: return e->abs;
+        default:        return e->rel;
+    }
+}
+
+int main(void) {
+    MathMeasureFunc measure[SIMD_ISA_COUNT] = {0};
+    measure[SIMD_ISA] = SIMD_NAME(math_measure);
+#if defined(__x86_64__)
+    measure[SIMD_ISA_AVX2] = SIMD_NAME_ISA(math_measure, avx2);
+    measure[SIMD_ISA_AVX512] = SIMD_NAME_ISA(math_measure, avx512);
+#endif
+
+    int failures = 0;
+    for (int isa = SIMD_ISA_NONE; isa <= detect_isa(); isa++) {
+        if (!measure[isa]) continue;
+        for (int p = 0; p < MATH_PRECISION_COUNT; p++) {
+            MathError errors[MATH_FUNC_COUNT];
+            measure[isa]((MathPrecision)p, errors);
+            printf("%s, %s:\n", isa_names[isa], config_math_precision_name((MathPrecision)p));
+            for (int f = 0; f < MATH_FUNC_COUNT; f++) {
+                const MathBound* bound = &bounds[p][f];
+                double error = error_of(&errors[f], bound->kind);
+                bool ok = error <= bound->limit;
+                printf("  %-5s %8.0f ulp  %.2e abs  %.2e rel  (%s <= %g) %s\n", func_names[f], errors[f].ulp,
+                       errors[f].abs, errors[f].rel, bound_names[bound->kind], bound->limit, ok ? "ok" : "FAIL");
+                if (!ok) failures++;
+            }
+        }
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "Error: %d math error bounds exceeded\n", failures);
+        return 1;
+    }
+    printf("All math error bounds hold\n");
+    return 0;
+}
+
+#endif // FIELD_SIMD_VARIANT